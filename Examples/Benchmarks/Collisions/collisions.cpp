@@ -0,0 +1,192 @@
+/**
+*   Collision detection between N shapes in a square world. The broad phase puts the shapes in a uniform
+*   grid and the narrow phase calls intersect (through table_omm) for every pair of shapes in the same
+*   or in neighbour cells. It reports the pairs per second and, if the hardware counters can be read,
+*   the cycles and the last level cache misses per dispatch.
+*
+*   Build: g++ -std=c++17 -O2 collisions.cpp -o collisions
+*
+*   Usage: collisions [count] [ellipses,circles,rectangles,triangles]
+*       count : The number of shapes (up to 10M). By default 1M.
+*       The second argument is the proportion of each type of shape. By default 10,40,30,20.
+*
+*   Example: collisions 10000000 0,50,50,0
+*
+*   If the counters are not available, try: sudo sysctl kernel.perf_event_paranoid=1
+*
+*   Building with -DOMM_PERF_COUNTERS also prints the counts per call collected by omm.
+*/
+
+#include "shapes.h"
+#include "../perf_counters.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/**
+*   Stores the shapes, sorted by the cell of the grid they belong to. The size of a cell is the maximum
+*   size of a shape, so two shapes can only intersect if they are in the same or in neighbour cells.
+*/
+struct world{
+
+    static constexpr double cell_size = 1.0;
+
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::vector<const Shape*> sorted;
+    std::vector<int> cell_start;
+    int side = 0;
+
+    int cell_of(const Shape& s) const{
+        int cx = std::min(side-1,static_cast<int>(s.x/cell_size));
+        int cy = std::min(side-1,static_cast<int>(s.y/cell_size));
+        return cy*side + cx;
+    }
+
+    // Counting sort of the shapes by cell.
+    void build_grid(){
+        cell_start.assign(side*side+1,0);
+        for (auto& s : shapes)
+            ++cell_start[cell_of(*s)+1];
+        for (int c = 0; c < side*side; ++c)
+            cell_start[c+1] += cell_start[c];
+        std::vector<int> next(cell_start.begin(),cell_start.end()-1);
+        sorted.resize(shapes.size());
+        for (auto& s : shapes)
+            sorted[next[cell_of(*s)]++] = s.get();
+    }
+
+    // Calls f for every pair of shapes that can intersect.
+    template<typename Function>
+    void for_each_candidate_pair(Function&& f) const{
+        static const int neighbours[4][2] = {{1,0},{-1,1},{0,1},{1,1}};
+        for (int cy = 0; cy < side; ++cy){
+            for (int cx = 0; cx < side; ++cx){
+                int c = cy*side + cx;
+                for (int i = cell_start[c]; i < cell_start[c+1]; ++i){
+                    for (int j = i+1; j < cell_start[c+1]; ++j)
+                        f(*sorted[i],*sorted[j]);
+                    for (auto& n : neighbours){
+                        int nx = cx + n[0], ny = cy + n[1];
+                        if (nx < 0 || nx >= side || ny >= side)
+                            continue;
+                        int d = ny*side + nx;
+                        for (int j = cell_start[d]; j < cell_start[d+1]; ++j)
+                            f(*sorted[i],*sorted[j]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+
+/**
+*   Creates the shapes at random positions. There is one shape per cell on average, and every shape fits
+*   in a cell.
+*/
+void populate(world& w, long count, const double (&mix)[4]){
+    w.side = std::max(1,static_cast<int>(std::sqrt(static_cast<double>(count))));
+    double size = w.side*world::cell_size;
+    double total = mix[0]+mix[1]+mix[2]+mix[3];
+
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> position(0.5,size-0.5);
+    std::uniform_real_distribution<double> extent(0.1,0.5);
+    std::uniform_real_distribution<double> kind(0.0,total);
+
+    w.shapes.reserve(count);
+    for (long i = 0; i < count; ++i){
+        double x = position(generator), y = position(generator);
+        double k = kind(generator);
+        if (k < mix[0])
+            w.shapes.push_back(std::make_unique<Ellipse>(x,y,extent(generator),extent(generator)));
+        else if (k < mix[0]+mix[1])
+            w.shapes.push_back(std::make_unique<Circle>(x,y,extent(generator)));
+        else if (k < mix[0]+mix[1]+mix[2])
+            w.shapes.push_back(std::make_unique<Rectangle>(x,y,extent(generator),extent(generator)));
+        else{
+            Point a{x-extent(generator),y-extent(generator)};
+            Point b{x+extent(generator),y-extent(generator)};
+            Point c{x,y+extent(generator)};
+            w.shapes.push_back(std::make_unique<Triangle>(a,b,c));
+        }
+    }
+}
+
+
+/**
+*   Runs the narrow phase with a dispatch function and prints the results.
+*/
+template<typename Dispatch>
+long narrow_phase(const char* name, const world& w, Dispatch&& dispatch){
+    perf_counters counters;
+    long pairs = 0;
+    long hits = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    counters.start();
+    w.for_each_candidate_pair([&](const Shape& a, const Shape& b){
+        ++pairs;
+        hits += dispatch(a,b) ? 1 : 0;
+    });
+    counters.stop();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end-start).count();
+    std::printf("%-12s pairs: %ld  hits: %ld  time: %.3f s  pairs/s: %.3g  ns/dispatch: %.2f",
+                name,pairs,hits,seconds,pairs/seconds,1e9*seconds/pairs);
+    if (counters.available())
+        std::printf("  cycles/dispatch: %.2f  LLC misses/dispatch: %.4f",
+                    static_cast<double>(counters.cycles)/pairs,static_cast<double>(counters.llc_misses)/pairs);
+    std::printf("\n");
+    return hits;
+}
+
+
+int main(int argc, char** argv){
+
+    long count = argc > 1 ? std::atol(argv[1]) : 1000000;
+    double mix[4] = {10,40,30,20};
+    if (argc > 2 && std::sscanf(argv[2],"%lf,%lf,%lf,%lf",&mix[0],&mix[1],&mix[2],&mix[3]) != 4){
+        std::printf("The mix must be four numbers separated by commas\n");
+        return 1;
+    }
+    if (count <= 0 || count > 10000000 || mix[0]+mix[1]+mix[2]+mix[3] <= 0){
+        std::printf("The count must be between 1 and 10000000, and the mix can not be zero\n");
+        return 1;
+    }
+
+    world w;
+    populate(w,count,mix);
+
+    auto start = std::chrono::steady_clock::now();
+    w.build_grid();
+    auto end = std::chrono::steady_clock::now();
+    std::printf("shapes: %ld  grid: %dx%d  broad phase: %.3f s\n",count,w.side,w.side,
+                std::chrono::duration<double>(end-start).count());
+    if (!perf_counters().available())
+        std::printf("Hardware counters are not available\n");
+
+    long hits = narrow_phase("table_call",w,[](const Shape& a, const Shape& b){
+        return intersect_table::table_call(a,b);
+    });
+    long tree_hits = narrow_phase("tree_call",w,[](const Shape& a, const Shape& b){
+        return intersect_table::tree_call(a,b);
+    });
+
+    if (hits != tree_hits){
+        std::printf("Error: table_call and tree_call do not find the same intersections\n");
+        return 1;
+    }
+
+#ifdef OMM_PERF_COUNTERS
+    report_dispatch_counters(stdout);
+#endif
+
+    return 0;
+
+}
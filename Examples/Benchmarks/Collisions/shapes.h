@@ -0,0 +1,165 @@
+#ifndef COLLISION_SHAPES_H_INCLUDED
+#define COLLISION_SHAPES_H_INCLUDED
+
+#include "../../../omm.h"
+#include <algorithm>
+#include <cmath>
+
+
+/**
+*   The shapes from the "Shapes and animals" example with a position and a size. Every shape knows
+*   its bounding box (center plus half extents), used by the broad phase.
+*/
+struct Shape{
+    Shape(double x, double y, double hx, double hy) : x(x), y(y), hx(hx), hy(hy){}
+    virtual ~Shape(){}
+    double x, y;
+    double hx, hy;
+};
+
+struct Ellipse : Shape{
+    Ellipse(double x, double y, double rx, double ry) : Shape(x,y,rx,ry){}
+};
+
+struct Circle : Ellipse{
+    Circle(double x, double y, double r) : Ellipse(x,y,r,r), r(r){}
+    double r;
+};
+
+struct Rectangle : Shape{
+    Rectangle(double x, double y, double hw, double hh) : Shape(x,y,hw,hh){}
+};
+
+struct Point{
+    double x, y;
+};
+
+struct Triangle : Shape{
+    Triangle(Point a, Point b, Point c)
+        : Shape((std::min({a.x,b.x,c.x})+std::max({a.x,b.x,c.x}))/2,(std::min({a.y,b.y,c.y})+std::max({a.y,b.y,c.y}))/2,
+                (std::max({a.x,b.x,c.x})-std::min({a.x,b.x,c.x}))/2,(std::max({a.y,b.y,c.y})-std::min({a.y,b.y,c.y}))/2),
+          p{a,b,c}{}
+    Point p[3];
+};
+
+
+//---------------------------------------------------------------------------------
+
+inline bool boxes_overlap(const Shape& a, const Shape& b){
+    return std::abs(a.x-b.x) <= a.hx+b.hx && std::abs(a.y-b.y) <= a.hy+b.hy;
+}
+
+inline double cross(Point o, Point a, Point b){
+    return (a.x-o.x)*(b.y-o.y) - (a.y-o.y)*(b.x-o.x);
+}
+
+// Projects the points onto an axis and checks whether the intervals are disjoint.
+template<int N, int M>
+inline bool separated(const Point (&a)[N], const Point (&b)[M], double ax, double ay){
+    double amin = a[0].x*ax + a[0].y*ay, amax = amin;
+    for (int i = 1; i < N; ++i){
+        double d = a[i].x*ax + a[i].y*ay;
+        amin = std::min(amin,d);
+        amax = std::max(amax,d);
+    }
+    double bmin = b[0].x*ax + b[0].y*ay, bmax = bmin;
+    for (int i = 1; i < M; ++i){
+        double d = b[i].x*ax + b[i].y*ay;
+        bmin = std::min(bmin,d);
+        bmax = std::max(bmax,d);
+    }
+    return amax < bmin || bmax < amin;
+}
+
+// Separating axis test with the normals of the edges of a.
+template<int N, int M>
+inline bool separated_by_edges(const Point (&a)[N], const Point (&b)[M]){
+    for (int i = 0; i < N; ++i){
+        Point u = a[i], v = a[(i+1)%N];
+        if (separated(a,b,v.y-u.y,u.x-v.x))
+            return true;
+    }
+    return false;
+}
+
+inline void corners(const Rectangle& r, Point (&p)[4]){
+    p[0] = {r.x-r.hx,r.y-r.hy};
+    p[1] = {r.x+r.hx,r.y-r.hy};
+    p[2] = {r.x+r.hx,r.y+r.hy};
+    p[3] = {r.x-r.hx,r.y+r.hy};
+}
+
+inline double segment_distance2(Point p, Point a, Point b){
+    double dx = b.x-a.x, dy = b.y-a.y;
+    double t = ((p.x-a.x)*dx + (p.y-a.y)*dy)/(dx*dx + dy*dy);
+    t = std::max(0.0,std::min(1.0,t));
+    double ex = a.x + t*dx - p.x, ey = a.y + t*dy - p.y;
+    return ex*ex + ey*ey;
+}
+
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Narrow phase. The pairs without an exact test (the ones with an Ellipse) use their bounding boxes.
+*/
+struct intersect_implementations{
+
+    static bool implementation(const Shape& a, const Shape& b){
+        return boxes_overlap(a,b);
+    }
+
+    static bool implementation(const Circle& a, const Circle& b){
+        double dx = a.x-b.x, dy = a.y-b.y, r = a.r+b.r;
+        return dx*dx + dy*dy <= r*r;
+    }
+
+    static bool implementation(const Circle& c, const Rectangle& r){
+        double dx = std::max(std::abs(c.x-r.x)-r.hx,0.0);
+        double dy = std::max(std::abs(c.y-r.y)-r.hy,0.0);
+        return dx*dx + dy*dy <= c.r*c.r;
+    }
+
+    static bool implementation(const Rectangle& r, const Circle& c){
+        return implementation(c,r);
+    }
+
+    static bool implementation(const Rectangle& a, const Rectangle& b){
+        return boxes_overlap(a,b);
+    }
+
+    static bool implementation(const Triangle& a, const Triangle& b){
+        return !separated_by_edges(a.p,b.p) && !separated_by_edges(b.p,a.p);
+    }
+
+    static bool implementation(const Triangle& t, const Rectangle& r){
+        Point p[4];
+        corners(r,p);
+        return boxes_overlap(t,r) && !separated_by_edges(t.p,p);
+    }
+
+    static bool implementation(const Rectangle& r, const Triangle& t){
+        return implementation(t,r);
+    }
+
+    static bool implementation(const Triangle& t, const Circle& c){
+        Point o{c.x,c.y};
+        double d0 = cross(t.p[0],t.p[1],o), d1 = cross(t.p[1],t.p[2],o), d2 = cross(t.p[2],t.p[0],o);
+        bool inside = (d0 >= 0 && d1 >= 0 && d2 >= 0) || (d0 <= 0 && d1 <= 0 && d2 <= 0);
+        double r2 = c.r*c.r;
+        return inside || segment_distance2(o,t.p[0],t.p[1]) <= r2 || segment_distance2(o,t.p[1],t.p[2]) <= r2
+                      || segment_distance2(o,t.p[2],t.p[0]) <= r2;
+    }
+
+    static bool implementation(const Circle& c, const Triangle& t){
+        return implementation(t,c);
+    }
+
+};
+
+using intersect_table = table_omm<WithImplementations<intersect_implementations>,
+                                  WithSignature<bool(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                  WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+
+#endif // COLLISION_SHAPES_H_INCLUDED
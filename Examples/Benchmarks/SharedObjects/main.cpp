@@ -0,0 +1,87 @@
+/**
+*   Compares the dispatch of objects created in a shared object loaded with RTLD_LOCAL, using
+*   table_omm::call and a lookup that compares the type_info objects with operator==.
+*
+*   Build:
+*       g++ -std=c++17 -O2 -fPIC -shared plugin.cpp -o libplugin.so
+*       g++ -std=c++17 -O2 main.cpp -o shared_objects -ldl
+*       ./shared_objects ./libplugin.so
+*/
+
+#include "../../../omm.h"
+#include "../benchmark.h"
+#include "shapes.h"
+#include <dlfcn.h>
+#include <vector>
+
+
+long result = 0;
+
+struct draw_implementations{
+
+    static void implementation(const Circle& c){ result += 1; }
+    static void implementation(const Ellipse& e){ result += 2; }
+    static void implementation(const Rectangle& r){ result += 3; }
+    static void implementation(const Square& s){ result += 4; }
+    static void implementation(const Triangle& t){ result += 5; }
+
+};
+
+using draw_table = table_omm<WithImplementations<draw_implementations>,
+                             WithSignature<void(Virtual<const Shape&>)>,
+                             WithDerivedTypes<Circle,Ellipse,Rectangle,Square,Triangle>>;
+
+// The lookup used before type_identity.
+template<typename D>
+struct same_type_operator{
+    static bool call(const std::type_info& info){
+        return info == typeid(D);
+    }
+};
+
+template<typename BM>
+struct position_with_operator{
+    static int call(const std::type_info& info){
+        return position_derived_runtime_aux<BM,same_type_operator>::call(info);
+    }
+};
+
+
+int main(int argc, char* argv[]){
+
+    void* plugin = dlopen(argc > 1 ? argv[1] : "./libplugin.so",RTLD_NOW | RTLD_LOCAL);
+    if (!plugin){
+        std::printf("Error: %s\n",dlerror());
+        return 1;
+    }
+    auto create_shape = reinterpret_cast<Shape*(*)(int)>(dlsym(plugin,"create_shape"));
+
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 4096; ++i)
+        shapes.push_back(create_shape(i*7));
+
+    std::printf("Same type_info objects: %s\n",&typeid(*shapes[0]) == &typeid(Circle) ? "yes" : "no");
+
+    const long iterations = 20000000;
+    using row = car_t<draw_table::TID>;
+
+    result = 0;
+    measure("operator== on type_info",iterations,[&](long i){
+        const Shape& s = *shapes[i%shapes.size()];
+        draw_table::table[position_with_operator<row>::call(typeid(s))](s);
+    });
+    long expected = result;
+
+    result = 0;
+    measure("table_omm::call (type_identity)",iterations,[&](long i){
+        draw_table::call(*shapes[i%shapes.size()]);
+    });
+
+    if (result != expected){
+        std::printf("Error: the results are different\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,13 @@
+#include "shapes.h"
+
+
+// Creates the shapes inside the shared object, so they use its type_info objects.
+extern "C" Shape* create_shape(int k){
+    switch (k%5){
+        case 0: return new Circle;
+        case 1: return new Ellipse;
+        case 2: return new Rectangle;
+        case 3: return new Square;
+        default: return new Triangle;
+    }
+}
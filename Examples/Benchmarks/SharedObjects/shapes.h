@@ -0,0 +1,22 @@
+#ifndef SHAPES_H_INCLUDED
+#define SHAPES_H_INCLUDED
+
+
+// Every virtual function is inline, so each shared object has its own type_info objects.
+
+struct Shape{
+    virtual ~Shape(){}
+};
+
+struct Circle : Shape{};
+
+struct Ellipse : Shape{};
+
+struct Rectangle : Shape{};
+
+struct Square : Shape{};
+
+struct Triangle : Shape{};
+
+
+#endif // SHAPES_H_INCLUDED
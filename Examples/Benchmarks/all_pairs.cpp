@@ -0,0 +1,108 @@
+/**
+*   Calls the intersect method of the Collisions benchmark for every pair of shapes from two sets, with
+*   nested loops of table_omm::call and with all_pairs, which identifies every shape once and walks the
+*   pairs by blocks of the same cell in tiles. Both are also run with a filter that checks the bounding
+*   boxes first. Prints the time of each one and checks that they find the same intersections.
+*
+*   Build: g++ -std=c++17 -O2 all_pairs.cpp -o all_pairs
+*
+*   Usage: all_pairs [first count] [second count]
+*       By default, 10000 shapes in each set.
+*/
+
+#include "../../omm_extras.h"
+#include "Collisions/shapes.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+std::vector<std::unique_ptr<Shape>> random_shapes(long count, unsigned seed){
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> position(0.0,100.0);
+    std::uniform_real_distribution<double> extent(0.1,0.5);
+    for (long i = 0; i < count; ++i){
+        double x = position(generator), y = position(generator);
+        switch (generator()%4){
+            case 0: shapes.push_back(std::make_unique<Ellipse>(x,y,extent(generator),extent(generator))); break;
+            case 1: shapes.push_back(std::make_unique<Circle>(x,y,extent(generator))); break;
+            case 2: shapes.push_back(std::make_unique<Rectangle>(x,y,extent(generator),extent(generator))); break;
+            default: shapes.push_back(std::make_unique<Triangle>(Point{x,y},Point{x+extent(generator),y},Point{x,y+extent(generator)}));
+        }
+    }
+    return shapes;
+}
+
+/**
+*   Runs f, which returns the number of intersections, and prints its time.
+*/
+template<typename Function>
+long run(const char* name, double pairs, Function&& f){
+    auto start = std::chrono::steady_clock::now();
+    long hits = f();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end-start).count();
+    std::printf("%-36s time: %7.3f s  ns/pair: %6.2f  hits: %ld\n",name,seconds,1e9*seconds/pairs,hits);
+    return hits;
+}
+
+
+int main(int argc, char** argv){
+
+    long n = argc > 1 ? std::atol(argv[1]) : 10000;
+    long m = argc > 2 ? std::atol(argv[2]) : n;
+    if (n <= 0 || m <= 0){
+        std::printf("The counts must be positive\n");
+        return 1;
+    }
+
+    auto first = random_shapes(n,1);
+    auto second = random_shapes(m,2);
+    double pairs = static_cast<double>(n)*m;
+    std::printf("pairs: %.0f\n",pairs);
+
+    auto overlap = [](const Shape& a, const Shape& b){
+        return boxes_overlap(a,b);
+    };
+
+    long hits[4];
+    hits[0] = run("nested loops of call",pairs,[&]{
+        long h = 0;
+        for (auto& a : first)
+            for (auto& b : second)
+                h += intersect_table::call(*a,*b);
+        return h;
+    });
+    hits[1] = run("all_pairs (identifying included)",pairs,[&]{
+        long h = 0;
+        all_pairs<intersect_table> engine(first,second);
+        engine.dispatch([&](const Shape& a, const Shape& b, bool hit){ h += hit; });
+        return h;
+    });
+    hits[2] = run("nested loops of call, filtered",pairs,[&]{
+        long h = 0;
+        for (auto& a : first)
+            for (auto& b : second)
+                if (overlap(*a,*b))
+                    h += intersect_table::call(*a,*b);
+        return h;
+    });
+    hits[3] = run("all_pairs, filtered",pairs,[&]{
+        long h = 0;
+        all_pairs<intersect_table> engine(first,second);
+        engine.dispatch_filtered(overlap,[&](const Shape& a, const Shape& b, bool hit){ h += hit; });
+        return h;
+    });
+
+    if (hits[0] != hits[1] || hits[0] != hits[2] || hits[0] != hits[3]){
+        std::printf("Error: all_pairs does not find the same intersections\n");
+        return 1;
+    }
+
+    return 0;
+
+}
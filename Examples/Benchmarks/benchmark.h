@@ -0,0 +1,45 @@
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+
+/**
+*   Prevents the compiler from removing a value that is not used.
+*/
+template<typename T>
+inline void do_not_optimize(T&& value){
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+*   Runs a function several times and returns the mean time per iteration in nanoseconds.
+*    - iterations : The number of times the function is called.
+*    - f : The function to measure. It receives the number of the current iteration.
+*/
+template<typename Function>
+double time_per_call(long iterations, Function&& f){
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+        f(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(end-start).count()/iterations;
+}
+
+/**
+*   Runs a function several times and prints the mean time per iteration.
+*    - name : The name printed next to the result.
+*    - iterations : The number of times the function is called.
+*    - f : The function to measure. It receives the number of the current iteration.
+*/
+template<typename Function>
+double measure(const char* name, long iterations, Function&& f){
+    double ns = time_per_call(iterations,std::forward<Function>(f));
+    std::printf("%-40s %8.2f ns\n",name,ns);
+    return ns;
+}
+
+
+#endif // BENCHMARK_H_INCLUDED
@@ -0,0 +1,91 @@
+/**
+*   Implementations that do their own work and then delegate to the next implementation: Circle
+*   delegates to Ellipse and Ellipse to Shape. Compares call_next with the call written by hand and
+*   with calling the cell of the next implementation, which is what can be done without call_next
+*   (calling table_omm::call again with cast arguments would dispatch to the same implementation).
+*
+*   Build: g++ -std=c++17 -O2 call_next.cpp -o call_next
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+
+enum class delegation{ call_next, by_hand, by_cell };
+
+template<delegation D>
+struct scale_implementations;
+
+template<delegation D>
+using scale_table = table_omm<WithImplementations<scale_implementations<D>>,
+                              WithSignature<long(Virtual<const Shape&>,long)>,
+                              WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// The slots of Ellipse and Shape, used to call their cells.
+int ellipse_slot = 0;
+int shape_slot = 0;
+
+template<delegation D>
+struct scale_implementations{
+
+    static long implementation(const Shape& s, long k){
+        return k;
+    }
+
+    static long implementation(const Ellipse& e, long k){
+        using T = scale_table<D>;
+        if (D == delegation::call_next)
+            return 2*k + T::call_next(e,k);
+        if (D == delegation::by_hand)
+            return 2*k + implementation(static_cast<const Shape&>(e),k);
+        return 2*k + T::cell(T::cell_of_slots(shape_slot))(e,k);
+    }
+
+    static long implementation(const Circle& c, long k){
+        using T = scale_table<D>;
+        if (D == delegation::call_next)
+            return 3*k + T::call_next(c,k);
+        if (D == delegation::by_hand)
+            return 3*k + implementation(static_cast<const Ellipse&>(c),k);
+        return 3*k + T::cell(T::cell_of_slots(ellipse_slot))(c,k);
+    }
+};
+
+
+int main(){
+
+    Shape shape; Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    const Shape* shapes[] = {&circle,&ellipse,&rectangle,&triangle};
+    ellipse_slot = scale_table<delegation::by_cell>::slot<0>(ellipse);
+    shape_slot = scale_table<delegation::by_cell>::slot<0>(shape);
+
+    std::vector<const Shape*> inputs;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i)
+        inputs.push_back(shapes[generator()%4]);
+
+    const long iterations = 20000000;
+    long results[3] = {0,0,0};
+
+    measure("call + call_next",iterations,[&](long i){
+        results[0] += scale_table<delegation::call_next>::call(*inputs[i%inputs.size()],i);
+    });
+    measure("call + call written by hand",iterations,[&](long i){
+        results[1] += scale_table<delegation::by_hand>::call(*inputs[i%inputs.size()],i);
+    });
+    measure("call + cell of the next implementation",iterations,[&](long i){
+        results[2] += scale_table<delegation::by_cell>::call(*inputs[i%inputs.size()],i);
+    });
+    do_not_optimize(results);
+
+    if (results[0] != results[1] || results[0] != results[2]){
+        std::printf("Error: call_next does not call the next implementation\n");
+        return 1;
+    }
+
+    return 0;
+
+}
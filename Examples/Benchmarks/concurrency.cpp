@@ -0,0 +1,324 @@
+/**
+*   Stress and scaling harness for calling the same omm tables from many threads. For several
+*   hierarchies, every thread calls table_omm::call (and tree_call) on its own random inputs over
+*   shared objects, and the harness prints the throughput for each number of threads and the
+*   efficiency: the speedup over one thread divided by the number of threads that can run at the same
+*   time. It also checks that:
+*    - Every thread gets the same results as a single thread.
+*    - The omm tables and keys are in read-only memory, so the calls can not write to any shared
+*      state of omm.
+*    - With -DOMM_PERF_COUNTERS, the counts of different threads are in different cache lines.
+*   An efficiency under 60% is flagged as contention. The last test increments a shared atomic in
+*   every call, so it shows how contention is reported.
+*
+*   Build: g++ -std=c++17 -O2 -pthread concurrency.cpp -o concurrency
+*
+*   Usage: concurrency [threads] [calls per thread]
+*       threads : The maximum number of threads. By default, the number of hardware threads.
+*       calls per thread : By default 4M.
+*
+*   ThreadSanitizer (the shared atomic of the last test is the only shared write, so no race
+*   should be reported):
+*       g++ -std=c++17 -O1 -g -fsanitize=thread -pthread concurrency.cpp -o concurrency_tsan
+*       ./concurrency_tsan 8 100000
+*/
+
+#include "../../omm_extras.h"
+#include "../Shapes and animals/shapes.h"
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//---------------------------------------------------------------------------------
+
+// The implementations only read their arguments, so the threads share nothing but the objects.
+struct shapes_implementations{
+    static int implementation(const Shape& a, const Shape& b){ return 1; }
+    static int implementation(const Circle& a, const Circle& b){ return 2; }
+    static int implementation(const Ellipse& a, const Rectangle& b){ return 3; }
+    static int implementation(const Rectangle& a, const Ellipse& b){ return 4; }
+    static int implementation(const Triangle& a, const Shape& b){ return 5; }
+};
+
+using shapes_table = table_omm<WithImplementations<shapes_implementations>,
+                               WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                               WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+struct animals_implementations{
+    static int implementation(Animal* a, const Shape& s1, const Shape& s2){ return 1; }
+    static int implementation(Dog* a, const Rectangle& s1, const Shape& s2){ return 2; }
+    static int implementation(Dog* a, const Circle& s1, const Ellipse& s2){ return 3; }
+    static int implementation(Cat* a, const Shape& s1, const Triangle& s2){ return 4; }
+    static int implementation(Cat* a, const Ellipse& s1, const Circle& s2){ return 5; }
+};
+
+using animals_table = table_omm<WithImplementations<animals_implementations>,
+                                WithSignature<int(Virtual<Animal*>,Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                WithDerivedTypes<Circle,Dog,Rectangle,Cat,Triangle,Ellipse>>;
+
+struct Move{ int dx, dy; };
+struct Attack{ int damage; };
+struct Chat{ int channel; };
+
+struct messages_implementations{
+    static int implementation(const Move* m){ return m->dx + m->dy; }
+    static int implementation(const Attack* a){ return a->damage; }
+    static int implementation(const Chat* c){ return c->channel; }
+    static int implementation(const std::any* a){ return 0; }
+};
+
+using messages_table = table_omm<WithImplementations<messages_implementations>,
+                                 WithSignature<int(Virtual<const std::any&>)>,
+                                 WithDerivedTypes<Move,Attack,Chat>>;
+
+// The control test: a shared write in every call.
+std::atomic<long> shared_calls{0};
+
+struct contended_implementations{
+    static int implementation(const Shape& a, const Shape& b){
+        shared_calls.fetch_add(1,std::memory_order_relaxed);
+        return 1;
+    }
+};
+
+using contended_table = table_omm<WithImplementations<contended_implementations>,
+                                  WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                  WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Runs f(thread, calls) in n threads at the same time and returns the calls per second of all the
+*   threads together. The result of every thread is stored in results.
+*/
+template<typename Function>
+double run_threads(int n, long calls, std::vector<long>& results, Function&& f){
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    results.assign(n,0);
+    for (int t = 0; t < n; ++t)
+        threads.emplace_back([&,t]{
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            results[t] = f(t,calls);
+        });
+    while (ready.load() < n)
+        std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true,std::memory_order_release);
+    for (auto& thread : threads)
+        thread.join();
+    auto end = std::chrono::steady_clock::now();
+    return n*calls/std::chrono::duration<double>(end-start).count();
+}
+
+int hardware_threads(){
+    return std::max(1u,std::thread::hardware_concurrency());
+}
+
+bool contention_found = false;
+bool error_found = false;
+
+/**
+*   Prints the throughput of a test for 1, 2, 4... up to max_threads threads.
+*    - name : The name of the test.
+*    - f : The function run by every thread. It receives the number of the thread and the number of calls,
+*          and returns the sum of the results of the calls. The sum of a thread does not depend on the
+*          number of threads.
+*    - expect_contention : Whether the test is the control test.
+*/
+template<typename Function>
+void scaling(const char* name, int max_threads, long calls, Function&& f, bool expect_contention = false){
+    std::vector<int> counts;
+    for (int n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+
+    std::vector<long> expected, results;
+    double single = run_threads(1,calls,expected,f);
+    std::printf("%s\n",name);
+    for (int n : counts){
+        double throughput = n == 1 ? single : run_threads(n,calls,results,f);
+        // The ideal speedup is the number of threads that can run at the same time.
+        double efficiency = throughput/(std::min(n,hardware_threads())*single);
+        bool flagged = efficiency < 0.6;
+        std::printf("  threads: %3d  calls/s: %10.4g  speedup: %6.2f  efficiency: %5.1f%%%s\n",
+                    n,throughput,throughput/single,100*efficiency,flagged ? "  <-- contention" : "");
+        if (flagged && !expect_contention)
+            contention_found = true;
+        if (n == 1)
+            continue;
+        // Thread 0 has the same inputs whatever the number of threads.
+        if (results[0] != expected[0]){
+            std::printf("  Error: the results with %d threads do not match the results with 1 thread\n",n);
+            error_found = true;
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the permissions of the mapping containing an address, as written in /proc/self/maps
+*   ("r--p", "rw-p"...), or an empty string if they can not be read.
+*/
+std::string permissions(const void* address){
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    auto value = reinterpret_cast<std::uintptr_t>(address);
+    while (std::getline(maps,line)){
+        std::istringstream in(line);
+        std::uintptr_t begin, end;
+        char dash;
+        std::string perms;
+        in >> std::hex >> begin >> dash >> end >> perms;
+        if (begin <= value && value < end)
+            return perms;
+    }
+    return "";
+}
+
+template<typename Table>
+void check_read_only(const char* name){
+    const void* addresses[2] = {&Table::table[0],Table::keys};
+    const char* parts[2] = {"table","keys"};
+    for (int i = 0; i < 2; ++i){
+        std::string perms = permissions(addresses[i]);
+        if (perms.empty()){
+            std::printf("  %-16s %-5s  can not read /proc/self/maps\n",name,parts[i]);
+            continue;
+        }
+        bool writable = perms[1] == 'w';
+        std::printf("  %-16s %-5s  %s%s\n",name,parts[i],perms.c_str(),writable ? "  <-- writable" : "");
+        if (writable)
+            contention_found = true;
+    }
+}
+
+#ifdef OMM_PERF_COUNTERS
+// The counts of every thread must be in their own cache line.
+void check_counter_lines(){
+    auto& registry = dispatch_counter_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<std::uintptr_t> lines;
+    for (auto& entry : registry.entries){
+        auto begin = reinterpret_cast<std::uintptr_t>(&entry.cell);
+        for (auto b = begin/64; b <= (begin+sizeof(entry.cell)-1)/64; ++b)
+            lines.push_back(b);
+    }
+    std::sort(lines.begin(),lines.end());
+    bool shared = std::adjacent_find(lines.begin(),lines.end()) != lines.end();
+    std::printf("  %zu counter cells%s\n",registry.entries.size(),shared ? "  <-- some of them share a cache line" : " in different cache lines");
+    if (shared)
+        contention_found = true;
+}
+#endif
+
+
+//---------------------------------------------------------------------------------
+
+int main(int argc, char** argv){
+
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : hardware_threads();
+    long calls = argc > 2 ? std::atol(argv[2]) : 4000000;
+    if (max_threads <= 0 || calls <= 0){
+        std::printf("The number of threads and calls must be positive\n");
+        return 1;
+    }
+    std::printf("hardware threads: %d  max threads: %d  calls per thread: %ld\n\n",hardware_threads(),max_threads,calls);
+
+    Dog dog; Cat cat;
+    Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    Animal* animals[] = {&dog,&cat};
+    const Shape* shapes[] = {&circle,&ellipse,&rectangle,&triangle};
+    const std::any messages[] = {Move{1,2},Attack{3},Chat{4},std::string("other")};
+
+    // The inputs of a thread only depend on its number.
+    constexpr int inputs = 1024;
+    auto random_inputs = [](int thread){
+        std::mt19937 generator(thread+1);
+        std::vector<int> v(3*inputs);
+        for (auto& x : v)
+            x = generator()%4;
+        return v;
+    };
+
+    scaling("Shape x Shape: call",max_threads,calls,[&](int t, long n){
+        auto in = random_inputs(t);
+        long sum = 0;
+        for (long i = 0; i < n; ++i){
+            int k = 3*(i%inputs);
+            sum += shapes_table::call(*shapes[in[k]],*shapes[in[k+1]]);
+        }
+        return sum;
+    });
+
+    scaling("Shape x Shape: tree_call",max_threads,calls,[&](int t, long n){
+        auto in = random_inputs(t);
+        long sum = 0;
+        for (long i = 0; i < n; ++i){
+            int k = 3*(i%inputs);
+            sum += shapes_table::tree_call(*shapes[in[k]],*shapes[in[k+1]]);
+        }
+        return sum;
+    });
+
+    scaling("Animal x Shape x Shape: call",max_threads,calls,[&](int t, long n){
+        auto in = random_inputs(t);
+        long sum = 0;
+        for (long i = 0; i < n; ++i){
+            int k = 3*(i%inputs);
+            sum += animals_table::call(animals[in[k]%2],*shapes[in[k+1]],*shapes[in[k+2]]);
+        }
+        return sum;
+    });
+
+    scaling("std::any: call",max_threads,calls,[&](int t, long n){
+        auto in = random_inputs(t);
+        long sum = 0;
+        for (long i = 0; i < n; ++i)
+            sum += messages_table::call(messages[in[3*(i%inputs)]]);
+        return sum;
+    });
+
+    scaling("Control, a shared atomic per call: call",max_threads,calls,[&](int t, long n){
+        auto in = random_inputs(t);
+        long sum = 0;
+        for (long i = 0; i < n; ++i){
+            int k = 3*(i%inputs);
+            sum += contended_table::call(*shapes[in[k]],*shapes[in[k+1]]);
+        }
+        return sum;
+    },true);
+
+    std::printf("\nShared state of omm\n");
+    check_read_only<shapes_table>("Shape x Shape");
+    check_read_only<animals_table>("Animal x Shape");
+    check_read_only<messages_table>("std::any");
+#ifdef OMM_PERF_COUNTERS
+    check_counter_lines();
+#endif
+
+    if (error_found)
+        std::printf("\nError: the threads did not get the expected results\n");
+    else if (contention_found)
+        std::printf("\nPossible contention in the omm tables\n");
+    else
+        std::printf("\nNo contention found\n");
+
+    return error_found ? 1 : 0;
+
+}
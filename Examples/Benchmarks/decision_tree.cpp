@@ -0,0 +1,83 @@
+/**
+*   Compares table_omm::table_call with table_omm::tree_call using the signature of example_function
+*   from the "Shapes and animals" example (3 virtual arguments).
+*
+*   Build: g++ -std=c++17 -O2 decision_tree.cpp -o decision_tree
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+
+long result = 0;
+
+struct bench_implementations{
+
+    // Every Cat cell calls this one: only the first argument is identified.
+    static void implementation(Cat* a, int k, volatile Shape* s1, float fl, const Shape& s2){
+        result += k;
+    }
+
+    // Every Dog cell with a Rectangle calls this one: the third argument is not identified.
+    static void implementation(Dog* a, int k, volatile Rectangle* s1, float fl, const Shape& s2){
+        result += 2*k;
+    }
+
+    static void implementation(Dog* a, int k, volatile Shape* s1, float fl, const Shape& s2){
+        result += 3*k;
+    }
+
+    static void implementation(Dog* a, int k, volatile Circle* s1, float fl, const Ellipse& s2){
+        result += 4*k;
+    }
+
+    static void implementation(Dog* a, int k, volatile Circle* s1, float fl, const Circle& s2){
+        result += 5*k;
+    }
+
+};
+
+using bench_table = table_omm<WithImplementations<bench_implementations>,
+                              WithSignature<void(Virtual<Animal*>,int,Virtual<volatile Shape*>,float,Virtual<const Shape&>)>,
+                              WithDerivedTypes<Circle,Dog,Rectangle,Cat,Triangle,Ellipse>>;
+
+
+int main(){
+
+    Dog dog; Cat cat;
+    Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    Animal* animals[] = {&dog,&cat};
+    Shape* shapes[] = {&circle,&ellipse,&rectangle,&triangle};
+
+    struct arguments{ Animal* a; Shape* s1; Shape* s2; };
+    std::vector<arguments> inputs;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i)
+        inputs.push_back({animals[generator()%2],shapes[generator()%4],shapes[generator()%4]});
+
+    const long iterations = 20000000;
+
+    result = 0;
+    measure("table_omm::table_call",iterations,[&](long i){
+        const arguments& in = inputs[i%inputs.size()];
+        bench_table::table_call(in.a,1,in.s1,1.0f,*in.s2);
+    });
+    long expected = result;
+
+    result = 0;
+    measure("table_omm::tree_call",iterations,[&](long i){
+        const arguments& in = inputs[i%inputs.size()];
+        bench_table::tree_call(in.a,1,in.s1,1.0f,*in.s2);
+    });
+
+    if (result != expected){
+        std::printf("Error: table_call and tree_call do not call the same implementations\n");
+        return 1;
+    }
+
+    return 0;
+
+}
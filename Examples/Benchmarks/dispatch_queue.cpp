@@ -0,0 +1,216 @@
+/**
+*   Producer threads submit event handlers dispatched on (Event, Handler) to a dispatch_queue, which
+*   groups them by cell and runs them on the consumer threads. Compares the throughput with calling
+*   table_omm::call on the producers, and prints the latency of the queued calls (from the submission to
+*   the end of the implementation): the median, the 99th and 99.9th percentiles and the maximum. Each
+*   producer keeps up to 256 calls queued, so the latency does not grow with the number of calls. It also
+*   checks that every queued call gets the same result as a direct call. Built as C++20, it also runs
+*   the calls from coroutines that await dispatch_queue::async.
+*
+*   Build: g++ -std=c++17 -O2 -pthread dispatch_queue.cpp -o dispatch_queue
+*          g++ -std=c++20 -O2 -pthread dispatch_queue.cpp -o dispatch_queue     (with coroutines)
+*
+*   Usage: dispatch_queue [producers] [consumers] [calls per producer]
+*       By default, 4 producers, 1 consumer and 200000 calls per producer.
+*/
+
+#include "../../omm_extras.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+
+//---------------------------------------------------------------------------------
+
+struct Event{
+    long code;
+    Event(long code) : code(code){}
+    virtual ~Event(){}
+};
+
+struct KeyEvent : Event{ using Event::Event; };
+struct MouseEvent : Event{ using Event::Event; };
+struct TimerEvent : Event{ using Event::Event; };
+
+struct Handler{
+    virtual ~Handler(){}
+};
+
+struct Logger : Handler{};
+struct Button : Handler{};
+struct Window : Handler{};
+
+long now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The handlers return a small result of the event and the time when they ran.
+struct handled{
+    long value;
+    long time;
+};
+
+struct handle_implementations{
+    static handled implementation(const Event& e, const Handler& h){ return {e.code,now()}; }
+    static handled implementation(const KeyEvent& e, const Button& h){ return {2*e.code+1,now()}; }
+    static handled implementation(const MouseEvent& e, const Button& h){ return {3*e.code+2,now()}; }
+    static handled implementation(const MouseEvent& e, const Window& h){ return {5*e.code+3,now()}; }
+    static handled implementation(const TimerEvent& e, const Logger& h){ return {7*e.code+4,now()}; }
+};
+
+using handle_table = table_omm<WithImplementations<handle_implementations>,
+                               WithSignature<handled(Virtual<const Event&>,Virtual<const Handler&>)>,
+                               WithDerivedTypes<KeyEvent,MouseEvent,TimerEvent,Logger,Button,Window>>;
+
+//---------------------------------------------------------------------------------
+
+KeyEvent key(1); MouseEvent mouse(2); TimerEvent timer(3);
+Logger logger; Button button; Window window;
+const Event* events[] = {&key,&mouse,&timer};
+const Handler* handlers[] = {&logger,&button,&window};
+
+const Event& event_of(long i){ return *events[(i*7)%3]; }
+const Handler& handler_of(long i){ return *handlers[(i*5/3)%3]; }
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+void print_latencies(std::vector<long>& latencies){
+    std::sort(latencies.begin(),latencies.end());
+    auto at = [&](double q){ return latencies[static_cast<std::size_t>(q*(latencies.size()-1))]/1000.0; };
+    std::printf("    latency (us): p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",at(0.5),at(0.99),at(0.999),at(1.0));
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+// A coroutine that starts at once and destroys itself at the end.
+struct detached{
+    struct promise_type{
+        detached get_return_object(){ return {}; }
+        std::suspend_never initial_suspend() noexcept{ return {}; }
+        std::suspend_never final_suspend() noexcept{ return {}; }
+        void return_void(){}
+        void unhandled_exception(){ std::terminate(); }
+    };
+};
+
+detached await_calls(dispatch_queue<handle_table>& queue, long first, long count, long* latencies, std::atomic<long>& done, std::atomic<bool>& correct){
+    for (long i = first; i < first+count; ++i){
+        long start = now();
+        handled h = co_await queue.async(event_of(i),handler_of(i));
+        latencies[i] = h.time-start;
+        if (h.value != handle_table::call(event_of(i),handler_of(i)).value)
+            correct = false;
+    }
+    done.fetch_add(count);
+}
+
+#endif
+
+
+int main(int argc, char** argv){
+
+    int producers = argc > 1 ? std::atoi(argv[1]) : 4;
+    int consumers = argc > 2 ? std::atoi(argv[2]) : 1;
+    long calls = argc > 3 ? std::atol(argv[3]) : 200000;
+    if (producers <= 0 || consumers <= 0 || calls <= 0){
+        std::printf("The producers, the consumers and the calls must be positive\n");
+        return 1;
+    }
+    long total = producers*calls;
+    std::printf("producers: %d  consumers: %d  calls: %ld  hardware threads: %u\n\n",producers,consumers,total,std::thread::hardware_concurrency());
+
+    // Direct calls on the producers.
+    std::vector<long> sums(producers,0);
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+            threads.emplace_back([&,p]{
+                for (long i = p*calls; i < (p+1)*calls; ++i)
+                    sums[p] += handle_table::call(event_of(i),handler_of(i)).value;
+            });
+        for (std::thread& t : threads)
+            t.join();
+    }
+    double seconds = seconds_since(start);
+    std::printf("table_omm::call on the producers\n    %.2f M calls/s\n",total/seconds/1e6);
+
+    // Queued calls with futures. Each producer waits for its oldest call when it has window calls queued.
+    const long window = 256;
+    bool correct = true;
+    std::vector<long> latencies(total);
+    {
+        dispatch_queue<handle_table> queue(consumers);
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        std::vector<char> matches(producers,1);
+        for (int p = 0; p < producers; ++p)
+            threads.emplace_back([&,p]{
+                std::vector<std::future<handled>> futures(window);
+                std::vector<long> submitted(window);
+                auto complete = [&](long i){
+                    handled h = futures[i%window].get();
+                    latencies[i] = h.time-submitted[i%window];
+                    if (h.value != handle_table::call(event_of(i),handler_of(i)).value)
+                        matches[p] = 0;
+                };
+                for (long i = p*calls; i < (p+1)*calls; ++i){
+                    if (i-p*calls >= window)
+                        complete(i-window);
+                    submitted[i%window] = now();
+                    futures[i%window] = queue.submit(event_of(i),handler_of(i));
+                }
+                for (long i = std::max((p+1)*calls-window,p*calls); i < (p+1)*calls; ++i)
+                    complete(i);
+            });
+        for (std::thread& t : threads)
+            t.join();
+        seconds = seconds_since(start);
+        correct = std::count(matches.begin(),matches.end(),0) == 0;
+    }
+    std::printf("dispatch_queue::submit\n    %.2f M calls/s\n",total/seconds/1e6);
+    print_latencies(latencies);
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    // Queued calls awaited by coroutines, 64 per producer.
+    {
+        const long per_coroutine = std::max(calls/64,1L);
+        const long coroutines = calls/per_coroutine;
+        std::atomic<long> done{0};
+        std::atomic<bool> matches{true};
+        dispatch_queue<handle_table> queue(consumers);
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+            threads.emplace_back([&,p]{
+                for (long c = 0; c < coroutines; ++c)
+                    await_calls(queue,p*calls+c*per_coroutine,per_coroutine,latencies.data(),done,matches);
+            });
+        for (std::thread& t : threads)
+            t.join();
+        long awaited = producers*coroutines*per_coroutine;
+        while (done.load() < awaited)
+            std::this_thread::yield();
+        seconds = seconds_since(start);
+        correct = correct && matches;
+        latencies.resize(awaited);
+        std::printf("dispatch_queue::async (%ld coroutines)\n    %.2f M calls/s\n",producers*coroutines,awaited/seconds/1e6);
+        print_latencies(latencies);
+    }
+#endif
+
+    if (!correct){
+        std::printf("Error: a queued call does not get the result of a direct call\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,180 @@
+/**
+*   Compares dispatching on the value of an enum (or an integer) with EnumValue against the usual workaround:
+*   a dummy subclass per value, whose static object is chosen with a switch and dispatched by its type.
+*   Both methods mix the value with a polymorphic Virtual argument:
+*    - The opcodes are dense, so their position is read from an array.
+*    - The ports are sparse, so they are compared with every listed port.
+*   Some opcodes and ports are not listed, so they reach the implementations receiving the enum (or int) itself.
+*   Prints the time per call of both versions and checks that they return the same results.
+*
+*   Build: g++ -std=c++17 -O2 enum_values.cpp -o enum_values
+*/
+
+#include "../../omm.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+
+enum class Opcode { Add, Sub, Mul, Div, Mod };
+
+struct Target{
+    virtual ~Target(){}
+};
+
+struct X86 : Target{};
+struct Arm : Target{};
+
+using targets = WithDerivedTypes<X86,Arm>;
+
+static_assert(enum_position<Opcode,Opcode::Add,Opcode::Sub,Opcode::Mul>::range < 256,"The opcodes must use the array");
+static_assert(enum_position<int,22,80,443,8080>::range >= 256,"The ports must use the comparisons");
+
+
+// The cost of an instruction, and the cost of a request to a port, in each target.
+struct cost_implementations{
+
+    static int implementation(Value<Opcode::Add>, const X86&){ return 1; }
+    static int implementation(Value<Opcode::Add>, const Arm&){ return 2; }
+    static int implementation(Value<Opcode::Sub>, const Target&){ return 3; }
+    static int implementation(Value<Opcode::Mul>, const X86&){ return 4; }
+    static int implementation(Value<Opcode::Mul>, const Target&){ return 5; }
+    static int implementation(Opcode, const Target&){ return 20; }
+
+    static int implementation(Value<22>, const Target&){ return 6; }
+    static int implementation(Value<80>, const X86&){ return 7; }
+    static int implementation(Value<80>, const Arm&){ return 8; }
+    static int implementation(Value<443>, const Target&){ return 9; }
+    static int implementation(Value<8080>, const Arm&){ return 10; }
+    static int implementation(int, const Target&){ return 30; }
+
+};
+
+using opcode_table = table_omm<WithImplementations<cost_implementations>,
+                               WithSignature<int(Virtual<EnumValue<Opcode,Opcode::Add,Opcode::Sub,Opcode::Mul>>,Virtual<const Target&>)>,
+                               targets>;
+
+using port_table = table_omm<WithImplementations<cost_implementations>,
+                             WithSignature<int(Virtual<EnumValue<int,22,80,443,8080>>,Virtual<const Target&>)>,
+                             targets>;
+
+
+// The workaround: a class per value, whose object is dispatched instead of the value.
+struct OpcodeTag{ virtual ~OpcodeTag(){} };
+struct AddTag : OpcodeTag{};
+struct SubTag : OpcodeTag{};
+struct MulTag : OpcodeTag{};
+
+struct PortTag{ virtual ~PortTag(){} };
+struct SshTag : PortTag{};
+struct HttpTag : PortTag{};
+struct HttpsTag : PortTag{};
+struct ProxyTag : PortTag{};
+
+const OpcodeTag& opcode_tag(Opcode op){
+    static const OpcodeTag other;
+    static const AddTag add;
+    static const SubTag sub;
+    static const MulTag mul;
+    switch (op){
+        case Opcode::Add: return add;
+        case Opcode::Sub: return sub;
+        case Opcode::Mul: return mul;
+        default: return other;
+    }
+}
+
+const PortTag& port_tag(int port){
+    static const PortTag other;
+    static const SshTag ssh;
+    static const HttpTag http;
+    static const HttpsTag https;
+    static const ProxyTag proxy;
+    switch (port){
+        case 22: return ssh;
+        case 80: return http;
+        case 443: return https;
+        case 8080: return proxy;
+        default: return other;
+    }
+}
+
+struct tag_cost_implementations{
+
+    static int implementation(const AddTag&, const X86&){ return 1; }
+    static int implementation(const AddTag&, const Arm&){ return 2; }
+    static int implementation(const SubTag&, const Target&){ return 3; }
+    static int implementation(const MulTag&, const X86&){ return 4; }
+    static int implementation(const MulTag&, const Target&){ return 5; }
+    static int implementation(const OpcodeTag&, const Target&){ return 20; }
+
+    static int implementation(const SshTag&, const Target&){ return 6; }
+    static int implementation(const HttpTag&, const X86&){ return 7; }
+    static int implementation(const HttpTag&, const Arm&){ return 8; }
+    static int implementation(const HttpsTag&, const Target&){ return 9; }
+    static int implementation(const ProxyTag&, const Arm&){ return 10; }
+    static int implementation(const PortTag&, const Target&){ return 30; }
+
+};
+
+using opcode_tag_table = table_omm<WithImplementations<tag_cost_implementations>,
+                                   WithSignature<int(Virtual<const OpcodeTag&>,Virtual<const Target&>)>,
+                                   WithDerivedTypes<AddTag,SubTag,MulTag,X86,Arm>>;
+
+using port_tag_table = table_omm<WithImplementations<tag_cost_implementations>,
+                                 WithSignature<int(Virtual<const PortTag&>,Virtual<const Target&>)>,
+                                 WithDerivedTypes<SshTag,HttpTag,HttpsTag,ProxyTag,X86,Arm>>;
+
+
+int main(){
+
+    X86 x86;
+    Arm arm;
+    const Target* machines[2] = {&x86,&arm};
+    const Opcode opcodes[5] = {Opcode::Add,Opcode::Sub,Opcode::Mul,Opcode::Div,Opcode::Mod};
+    const int ports[6] = {22,80,443,8080,25,3306};
+
+    std::vector<std::pair<Opcode,const Target*>> instructions;
+    std::vector<std::pair<int,const Target*>> requests;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i){
+        instructions.push_back({opcodes[generator()%5],machines[generator()%2]});
+        requests.push_back({ports[generator()%6],machines[generator()%2]});
+    }
+
+    const long iterations = 20000000;
+    long results[4] = {0,0,0,0};
+
+    measure("dummy subclasses (dense opcodes)",iterations,[&](long i){
+        auto& p = instructions[i%instructions.size()];
+        results[0] += opcode_tag_table::call(opcode_tag(p.first),*p.second);
+    });
+    measure("EnumValue (dense opcodes)",iterations,[&](long i){
+        auto& p = instructions[i%instructions.size()];
+        results[1] += opcode_table::call(p.first,*p.second);
+    });
+    measure("dummy subclasses (sparse ports)",iterations,[&](long i){
+        auto& p = requests[i%requests.size()];
+        results[2] += port_tag_table::call(port_tag(p.first),*p.second);
+    });
+    measure("EnumValue (sparse ports)",iterations,[&](long i){
+        auto& p = requests[i%requests.size()];
+        results[3] += port_table::call(p.first,*p.second);
+    });
+    do_not_optimize(results);
+
+    if (results[0] != results[1] || results[2] != results[3]){
+        std::printf("Error: the results are different\n");
+        return 1;
+    }
+
+    // The values that are not listed are treated like the enum itself.
+    if (opcode_table::call(Opcode::Div,x86) != 20 || opcode_table::call(Opcode::Mod,arm) != 20 ||
+        port_table::call(25,arm) != 30 || port_table::call(8080,x86) != 30 || port_table::call(8080,arm) != 10){
+        std::printf("Error: an unlisted value does not reach the implementation of any value\n");
+        return 1;
+    }
+
+    return 0;
+
+}
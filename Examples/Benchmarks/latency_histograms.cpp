@@ -0,0 +1,125 @@
+/**
+*   Measures the cost of OMM_LATENCY_HISTOGRAMS. Build it with and without the histograms and compare
+*   the time per call of table_call and tree_call (the best of several runs). One of the implementations
+*   is slower than the rest, so with the histograms its cell should top the report, which merges the
+*   calls of the main thread and of a second thread. It also checks that the calls to a symmetric method go to
+*   the histogram of their cell.
+*
+*   Build both versions:
+*       g++ -std=c++17 -O2 -pthread latency_histograms.cpp -o latency_off
+*       g++ -std=c++17 -O2 -pthread -DOMM_LATENCY_HISTOGRAMS latency_histograms.cpp -o latency_on
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+int slow_work(int n){
+    int x = 0;
+    for (int i = 0; i < n; ++i)
+        do_not_optimize(x += i);
+    return x & 7;
+}
+
+struct shapes_implementations{
+    static int implementation(const Shape& a, const Shape& b){ return 1; }
+    static int implementation(const Circle& a, const Circle& b){ return 2; }
+    static int implementation(const Ellipse& a, const Rectangle& b){ return 3 + slow_work(64); }
+    static int implementation(const Rectangle& a, const Ellipse& b){ return 4; }
+    static int implementation(const Triangle& a, const Shape& b){ return 5; }
+};
+
+using shapes_table = table_omm<WithImplementations<shapes_implementations>,
+                               WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                               WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// A symmetric method, whose calls are swapped when needed.
+struct intersect_implementations{
+    static int implementation(const Shape& a, const Shape& b){ return 1; }
+    static int implementation(const Circle& a, const Rectangle& b){ return 2; }
+};
+
+using intersect_table = symmetric_table_omm<WithImplementations<intersect_implementations>,
+                                            WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                            WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+
+int main(){
+
+#ifdef OMM_LATENCY_HISTOGRAMS
+    std::printf("OMM_LATENCY_HISTOGRAMS: on\n");
+#else
+    std::printf("OMM_LATENCY_HISTOGRAMS: off\n");
+#endif
+
+    Shape shape; Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    const Shape* shapes[] = {&shape,&circle,&ellipse,&rectangle,&triangle};
+    std::vector<std::pair<const Shape*,const Shape*>> pairs;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i)
+        pairs.push_back({shapes[generator()%5],shapes[generator()%5]});
+
+    // The best of several runs, so the noise does not decide.
+    const long iterations = 10000000;
+    long results[2] = {0,0};
+    double best[2] = {1e9,1e9};
+    for (int run = 0; run < 5; ++run){
+        best[0] = std::min(best[0],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            results[0] += shapes_table::table_call(*p.first,*p.second);
+        }));
+        best[1] = std::min(best[1],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            results[1] += shapes_table::tree_call(*p.first,*p.second);
+        }));
+    }
+    std::printf("%-40s %8.2f ns\n","table_call",best[0]);
+    std::printf("%-40s %8.2f ns\n","tree_call",best[1]);
+    do_not_optimize(results);
+
+#ifdef OMM_LATENCY_HISTOGRAMS
+    // Only the calls made from here, on this thread and on a second one, go to the report.
+    reset_latency_histograms();
+    long other = 0;
+    std::thread thread([&]{
+        for (long i = 0; i < iterations; ++i){
+            auto& p = pairs[(i*7)%pairs.size()];
+            other += shapes_table::call(*p.first,*p.second);
+        }
+    });
+    long last = 0;
+    for (long i = 0; i < iterations; ++i){
+        auto& p = pairs[i%pairs.size()];
+        last += shapes_table::call(*p.first,*p.second);
+    }
+    thread.join();
+    do_not_optimize(other);
+    do_not_optimize(last);
+    std::printf("timestamps per ns: %.3f\n\n",dispatch_ticks_per_ns());
+    report_latency_histograms(4,stdout);
+
+    // The calls to a symmetric method go to their cell, whatever the order of the arguments.
+    reset_latency_histograms();
+    for (long i = 0; i < 1000; ++i)
+        last += intersect_table::call(rectangle,circle) + intersect_table::call(circle,rectangle);
+    do_not_optimize(last);
+    bool attributed = true;
+    std::uint64_t calls = 0;
+    for (const latency_histogram_record& r : latency_histogram_snapshot()){
+        attributed = attributed && (r.calls == 0 || r.cell == intersect_table::cell_of(circle,rectangle));
+        calls += r.calls;
+    }
+    if (!attributed || calls != 2000){
+        std::printf("Error: the calls to the symmetric method are not attributed to their cell\n");
+        return 1;
+    }
+#endif
+
+    return results[0] == results[1] ? 0 : 1;
+
+}
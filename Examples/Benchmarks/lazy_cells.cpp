@@ -0,0 +1,163 @@
+/**
+*   Compares the encodings of several large omm tables, with three virtual arguments and a few
+*   implementations each. With pointer_encoding and index_encoding the program stores every cell, and with
+*   pointer_encoding every cell needs a relocation at startup. With lazy_encoding it only stores the functions
+*   of the implementations and the resolver, and each cell is resolved the first time it is called. Prints
+*   the bytes stored by the tables, the size of the program, and the time per call of the first and the
+*   second call to each cell of a table (in a random order, so the prefetcher does not hide the misses).
+*   The tables use the default strategy, or the table strategy with TABLE_STRATEGY. Checks that both
+*   strategies call the same implementation in every cell.
+*
+*   Build the versions (the lists of cells need a deeper template recursion):
+*       g++ -std=c++17 -O2 -ftemplate-depth=4096 lazy_cells.cpp -o lazy_cells_pointers
+*       g++ -std=c++17 -O2 -ftemplate-depth=4096 -DINDEX_ENCODING lazy_cells.cpp -o lazy_cells_indices
+*       g++ -std=c++17 -O2 -ftemplate-depth=4096 -DLAZY_ENCODING lazy_cells.cpp -o lazy_cells_lazy
+*       g++ -std=c++17 -O2 -ftemplate-depth=4096 -DLAZY_ENCODING -DTABLE_STRATEGY lazy_cells.cpp -o lazy_cells_lazy_table
+*
+*   Compare the stripped programs, the relocations and the sections (the cache of lazy_encoding is in .bss):
+*       strip -o stripped lazy_cells_lazy && ls -l stripped
+*       readelf -r lazy_cells_lazy | grep -c R_X86_64_RELATIVE
+*       size -A lazy_cells_lazy | grep -E "^.text|data.rel.ro|^.bss"
+*/
+
+#include "../../omm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+struct Node{
+    virtual ~Node(){}
+};
+
+template<int K>
+struct Leaf : Node{};
+
+/**
+*   The implementations of the method number M: a default, one per leaf in the first argument, and a
+*   couple of specific ones.
+*/
+template<int M>
+struct method_implementations{
+
+    static int implementation(const Node& a, const Node& b, const Node& c){
+        return M;
+    }
+
+    template<int A>
+    static int implementation(const Leaf<A>& a, const Node& b, const Node& c){
+        return M + A;
+    }
+
+    static int implementation(const Leaf<1>& a, const Leaf<6>& b, const Node& c){
+        return M + 100;
+    }
+
+    static int implementation(const Leaf<2>& a, const Node& b, const Leaf<3>& c){
+        return M + 200;
+    }
+};
+
+#if defined(LAZY_ENCODING)
+using encoding = WithEncoding<lazy_encoding>;
+#elif defined(INDEX_ENCODING)
+using encoding = WithEncoding<index_encoding>;
+#else
+using encoding = WithEncoding<pointer_encoding>;
+#endif
+
+#ifdef TABLE_STRATEGY
+using strategy = WithStrategy<table_strategy>;
+#else
+using strategy = WithStrategy<automatic_strategy>;
+#endif
+
+template<typename IS>
+struct leaves{};
+
+template<int... KS>
+struct leaves<std::integer_sequence<int,KS...>>{
+    using type = WithDerivedTypes<Leaf<KS>...>;
+};
+
+constexpr int leaf_count = 11;
+
+template<int M>
+using method_table = table_omm<WithImplementations<method_implementations<M>>,
+                               WithSignature<int(Virtual<const Node&>,Virtual<const Node&>,Virtual<const Node&>)>,
+                               typename leaves<std::make_integer_sequence<int,leaf_count>>::type,
+                               strategy,
+                               encoding>;
+
+constexpr int methods = 8;
+
+template<int... MS>
+long call_all(std::integer_sequence<int,MS...>, const Node& a, const Node& b, const Node& c){
+    return (method_table<MS>::call(a,b,c) + ...);
+}
+
+template<int... MS>
+std::size_t bytes_all(std::integer_sequence<int,MS...>){
+    return (method_table<MS>::table_bytes + ...);
+}
+
+template<int... KS>
+std::vector<const Node*> make_nodes(std::integer_sequence<int,KS...>){
+    static Node node;
+    static std::tuple<Leaf<KS>...> leaves;
+    return {&node,&std::get<KS>(leaves)...};
+}
+
+long program_bytes(){
+    std::FILE* file = std::fopen("/proc/self/exe","rb");
+    if (!file)
+        return -1;
+    std::fseek(file,0,SEEK_END);
+    long bytes = std::ftell(file);
+    std::fclose(file);
+    return bytes;
+}
+
+
+int main(int argc, char** argv){
+
+    std::vector<const Node*> nodes = make_nodes(std::make_integer_sequence<int,leaf_count>{});
+    int n = static_cast<int>(nodes.size());
+
+    // Every cell of the first table, in a random order.
+    std::vector<int> cells(n*n*n);
+    for (int i = 0; i < n*n*n; ++i)
+        cells[i] = i;
+    std::shuffle(cells.begin(),cells.end(),std::mt19937(42));
+
+    using table = method_table<0>;
+    long result = 0;
+    double ns[2];
+    for (int pass = 0; pass < 2; ++pass){
+        auto start = std::chrono::steady_clock::now();
+        for (int i : cells)
+            result += table::call(*nodes[i/(n*n)],*nodes[i/n%n],*nodes[i%n]);
+        ns[pass] = std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-start).count()/cells.size();
+    }
+
+    // Every table is used, so all of them are in the program.
+    result += call_all(std::make_integer_sequence<int,methods>{},*nodes[argc%n],*nodes[(argc+6)%n],*nodes[(argc+3)%n]);
+
+    std::printf("encoding: %s  strategy: %s  tables: %d  cells per table: %d  table bytes: %zu  program bytes: %ld\n",
+                table::layout.encoding,table::layout.strategy,methods,table::cells,bytes_all(std::make_integer_sequence<int,methods>{}),
+                program_bytes());
+    std::printf("first call to each cell: %.1f ns  second call: %.1f ns  result: %ld\n",ns[0],ns[1],result);
+
+    for (int i : cells)
+        if (table::table_call(*nodes[i/(n*n)],*nodes[i/n%n],*nodes[i%n]) != table::tree_call(*nodes[i/(n*n)],*nodes[i/n%n],*nodes[i%n])){
+            std::printf("Error: the strategies call different implementations in the cell %d\n",i);
+            return 1;
+        }
+
+    return 0;
+
+}
@@ -0,0 +1,96 @@
+/**
+*   Shows that the calls to an omm table whose implementations are all noexcept do not need
+*   exception handling code. Both functions below call a method while a std::string is alive, so
+*   the compiler needs a landing pad to destroy it only if the call can throw.
+*
+*   Build: g++ -std=c++17 -O2 -c noexcept_codegen.cpp -o noexcept_codegen.o
+*
+*   The landing pads can be listed with:
+*       objdump -d -C -r noexcept_codegen.o | grep -E "^[0-9a-f]+ <call_|_Unwind_Resume"
+*   Only call_may_throw has a cold part that calls _Unwind_Resume.
+*/
+
+#include "../../omm.h"
+#include <string>
+
+
+struct Shape{
+    virtual ~Shape(){}
+};
+
+struct Circle : Shape{};
+struct Rectangle : Shape{};
+
+
+struct nothrow_implementations{
+
+    static int implementation(const Circle& c, const Circle& d) noexcept{
+        return 1;
+    }
+
+    static int implementation(const Shape& s, const Shape& t) noexcept{
+        return 2;
+    }
+
+};
+
+struct may_throw_implementations{
+
+    static int implementation(const Circle& c, const Circle& d){
+        return 1;
+    }
+
+    static int implementation(const Shape& s, const Shape& t) noexcept{
+        return 2;
+    }
+
+};
+
+struct nothrow_pointer_implementations{
+
+    static int implementation(const Shape* s, const Shape* t) noexcept{
+        return 3;
+    }
+
+};
+
+using shapes = WithDerivedTypes<Circle,Rectangle>;
+
+using nothrow_table = table_omm<WithImplementations<nothrow_implementations>,
+                                WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                shapes>;
+
+using may_throw_table = table_omm<WithImplementations<may_throw_implementations>,
+                                  WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                  shapes>;
+
+using nothrow_pointer_table = table_omm<WithImplementations<nothrow_pointer_implementations>,
+                                        WithSignature<int(Virtual<const Shape*>,Virtual<const Shape*>)>,
+                                        shapes>;
+
+static_assert(is_nothrow_omm_v<nothrow_table>,"Every implementation is noexcept");
+static_assert(!is_nothrow_omm_v<may_throw_table>,"One implementation is not noexcept");
+static_assert(noexcept(nothrow_table::call(std::declval<Shape&>(),std::declval<Shape&>())),"The call is noexcept");
+// typeid throws std::bad_typeid for a null pointer, so only the cells are noexcept.
+static_assert(is_nothrow_omm_v<nothrow_pointer_table>,"Every implementation is noexcept");
+static_assert(!noexcept(nothrow_pointer_table::call(std::declval<Shape*>(),std::declval<Shape*>())),"The lookup can throw");
+static_assert(noexcept(nothrow_pointer_table::cell(0)(std::declval<Shape*>(),std::declval<Shape*>())),"The cell is noexcept");
+
+
+void consume(const std::string& s) noexcept;
+
+int call_nothrow(const Shape& s, const Shape& t){
+    std::string name = "nothrow";
+    consume(name);
+    int result = nothrow_table::call(s,t);
+    consume(name);
+    return result;
+}
+
+int call_may_throw(const Shape& s, const Shape& t){
+    std::string name = "may_throw";
+    consume(name);
+    int result = may_throw_table::call(s,t);
+    consume(name);
+    return result;
+}
@@ -0,0 +1,172 @@
+/**
+*   Reduces a heterogeneous range of nodes with an associative multi-method, merge, which returns a new
+*   node with the statistics of both. Compares the left fold on one thread, written with table_omm::call,
+*   with parallel_reduce for each number of threads, using both shapes of the tree. Prints the time, the
+*   speedup over one thread and the efficiency (the speedup divided by the number of threads), and checks
+*   that:
+*    - Every reduction has the same count and the same ordered hash as the left fold, so the elements
+*      are combined in order.
+*    - The sum of doubles, whose rounding depends on the tree, is the same for every number of threads
+*      with reduction_tree::fixed.
+*
+*   Build: g++ -std=c++17 -O2 -pthread parallel_reduce.cpp -o parallel_reduce
+*
+*   Usage: parallel_reduce [threads] [elements]
+*       threads : The maximum number of threads. By default, the number of hardware threads.
+*       elements : By default 1M.
+*/
+
+#include "../../omm_extras.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+//---------------------------------------------------------------------------------
+
+// Every node knows the statistics of the elements it stands for. The hash depends on their order.
+struct Node{
+    long count;
+    double sum;
+    std::uint64_t hash;
+    std::uint64_t power;    // 31^count, to append a hash.
+    Node(long count, double sum, std::uint64_t hash, std::uint64_t power) : count(count), sum(sum), hash(hash), power(power){}
+    virtual ~Node(){}
+};
+
+struct Sample : Node{
+    Sample(double x, std::uint64_t id) : Node(1,x,id,31){}
+};
+
+struct Marker : Node{
+    Marker(std::uint64_t id) : Node(1,0.0,id,31){}
+};
+
+struct Summary : Node{
+    using Node::Node;
+};
+
+struct Empty : Node{
+    Empty() : Node(0,0.0,0,1){}
+};
+
+std::unique_ptr<Node> merge_nodes(const Node& a, const Node& b){
+    return std::make_unique<Summary>(a.count+b.count,a.sum+b.sum,a.hash*b.power+b.hash,a.power*b.power);
+}
+
+struct merge_implementations{
+
+    static std::unique_ptr<Node> implementation(const Node& a, const Node& b){
+        return merge_nodes(a,b);
+    }
+
+    static std::unique_ptr<Node> implementation(const Empty& a, const Node& b){
+        return std::make_unique<Summary>(b.count,b.sum,b.hash,b.power);
+    }
+
+    static std::unique_ptr<Node> implementation(const Sample& a, const Sample& b){
+        return std::make_unique<Summary>(2,a.sum+b.sum,a.hash*31+b.hash,31*31);
+    }
+
+    static std::unique_ptr<Node> implementation(const Summary& a, const Marker& b){
+        return std::make_unique<Summary>(a.count+1,a.sum,a.hash*31+b.hash,a.power*31);
+    }
+
+    static std::unique_ptr<Node> implementation(const Summary& a, const Sample& b){
+        return std::make_unique<Summary>(a.count+1,a.sum+b.sum,a.hash*31+b.hash,a.power*31);
+    }
+};
+
+using merge_table = table_omm<WithImplementations<merge_implementations>,
+                              WithSignature<std::unique_ptr<Node>(Virtual<const Node&>,Virtual<const Node&>)>,
+                              WithDerivedTypes<Sample,Marker,Summary,Empty>>;
+
+//---------------------------------------------------------------------------------
+
+struct outcome{
+    double seconds;
+    long count;
+    double sum;
+    std::uint64_t hash;
+};
+
+template<typename Function>
+outcome run(Function&& f){
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Node> result = f();
+    auto end = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double>(end-start).count(),result->count,result->sum,result->hash};
+}
+
+template<reduction_tree Tree>
+outcome reduce(thread_pool& pool, std::vector<std::unique_ptr<Node>>& nodes){
+    return run([&]{
+        return parallel_reduce<merge_table,Tree>(pool,nodes,std::make_unique<Empty>());
+    });
+}
+
+
+int main(int argc, char** argv){
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    unsigned max_threads = argc > 1 ? std::atoi(argv[1]) : (hardware ? hardware : 1);
+    long elements = argc > 2 ? std::atol(argv[2]) : 1000000;
+    if (max_threads == 0 || elements <= 0){
+        std::printf("The threads and the elements must be positive\n");
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> value(-1.0,1.0);
+    for (long i = 0; i < elements; ++i){
+        if (generator()%8)
+            nodes.push_back(std::make_unique<Sample>(value(generator),generator()));
+        else
+            nodes.push_back(std::make_unique<Marker>(generator()));
+    }
+
+    outcome fold = run([&]{
+        std::unique_ptr<Node> result = std::make_unique<Empty>();
+        for (auto& node : nodes)
+            result = merge_table::call(*result,*node);
+        return result;
+    });
+    std::printf("hardware threads: %u  elements: %ld\n",hardware,elements);
+    std::printf("left fold with call, one thread: %.3f s\n\n",fold.seconds);
+
+    std::printf("%8s  %-10s %9s %9s %11s\n","threads","tree","time (s)","speedup","efficiency");
+    bool correct = true;
+    outcome first[2];
+    for (unsigned threads = 1; threads <= max_threads; threads = threads < max_threads && 2*threads > max_threads ? max_threads : 2*threads){
+        thread_pool pool(threads);
+        outcome results[2] = {reduce<reduction_tree::per_thread>(pool,nodes),reduce<reduction_tree::fixed>(pool,nodes)};
+        const char* names[2] = {"per_thread","fixed"};
+        for (int k = 0; k < 2; ++k){
+            if (threads == 1)
+                first[k] = results[k];
+            double speedup = first[k].seconds/results[k].seconds;
+            std::printf("%8u  %-10s %9.3f %9.2f %10.0f%%\n",threads,names[k],results[k].seconds,speedup,100.0*speedup/threads);
+            if (results[k].count != fold.count || results[k].hash != fold.hash){
+                std::printf("Error: the elements were not combined in order\n");
+                correct = false;
+            }
+        }
+        if (results[1].sum != first[1].sum){
+            std::printf("Error: the fixed tree gives a different sum with %u threads\n",threads);
+            correct = false;
+        }
+        if (threads == max_threads)
+            break;
+    }
+    if (hardware < max_threads)
+        std::printf("\nThere are more threads than hardware threads, so they can not scale.\n");
+
+    return correct ? 0 : 1;
+
+}
@@ -0,0 +1,109 @@
+#ifndef PERF_COUNTERS_H_INCLUDED
+#define PERF_COUNTERS_H_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_AVAILABLE 1
+#else
+#define PERF_COUNTERS_AVAILABLE 0
+#endif
+
+
+/**
+*   Counts hardware events of the current thread with perf_event_open. If the counters can not be
+*   opened (other systems, containers or a restrictive perf_event_paranoid), available() returns false
+*   and every count is zero.
+*    - cycles : CPU cycles.
+*    - llc_misses : Last level cache misses.
+*/
+class perf_counters{
+
+public:
+
+    perf_counters(){
+        cycles_fd = open_counter(PERF_TYPE_ID_CYCLES,-1);
+        llc_fd = open_counter(PERF_TYPE_ID_CACHE_MISSES,cycles_fd);
+    }
+
+    ~perf_counters(){
+#if PERF_COUNTERS_AVAILABLE
+        if (llc_fd >= 0)
+            close(llc_fd);
+        if (cycles_fd >= 0)
+            close(cycles_fd);
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool available() const{
+        return cycles_fd >= 0;
+    }
+
+    void start(){
+#if PERF_COUNTERS_AVAILABLE
+        if (cycles_fd >= 0){
+            ioctl(cycles_fd,PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+            ioctl(cycles_fd,PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    void stop(){
+#if PERF_COUNTERS_AVAILABLE
+        if (cycles_fd >= 0)
+            ioctl(cycles_fd,PERF_EVENT_IOC_DISABLE,PERF_IOC_FLAG_GROUP);
+        cycles = read_counter(cycles_fd);
+        llc_misses = read_counter(llc_fd);
+#endif
+    }
+
+    std::uint64_t cycles = 0;
+    std::uint64_t llc_misses = 0;
+
+private:
+
+#if PERF_COUNTERS_AVAILABLE
+    static constexpr std::uint64_t PERF_TYPE_ID_CYCLES = PERF_COUNT_HW_CPU_CYCLES;
+    static constexpr std::uint64_t PERF_TYPE_ID_CACHE_MISSES = PERF_COUNT_HW_CACHE_MISSES;
+
+    static int open_counter(std::uint64_t config, int group){
+        perf_event_attr attr;
+        std::memset(&attr,0,sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(__NR_perf_event_open,&attr,0,-1,group,0));
+    }
+
+    static std::uint64_t read_counter(int fd){
+        std::uint64_t value = 0;
+        if (fd < 0 || read(fd,&value,sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+            return 0;
+        return value;
+    }
+#else
+    static constexpr std::uint64_t PERF_TYPE_ID_CYCLES = 0;
+    static constexpr std::uint64_t PERF_TYPE_ID_CACHE_MISSES = 0;
+
+    static int open_counter(std::uint64_t config, int group){
+        return -1;
+    }
+#endif
+
+    int cycles_fd = -1;
+    int llc_fd = -1;
+};
+
+
+#endif // PERF_COUNTERS_H_INCLUDED
@@ -0,0 +1,181 @@
+/**
+*   Calls a method with the four policies. Each checked policy is called with an object whose type is not
+*   passed to WithDerivedTypes (the unknown type cell) and with a pair of objects without implementation
+*   (a missing implementation cell). abort_on_error is called in a child process, which must end with SIGABRT.
+*   With assume_valid, the table and the keys must be exactly the ones of the table without policy, which is
+*   checked in compile time. Prints the time per valid call of each table.
+*
+*   Build: g++ -std=c++17 -O2 policies.cpp -o policies
+*
+*   The code of a call with and without assume_valid can also be compared:
+*       g++ -std=c++17 -O2 -c policies.cpp -o policies.o
+*       objdump -d -C --no-show-raw-insn policies.o | sed -n "/<call_without_policy/,/^$/p" | cut -f2-
+*       objdump -d -C --no-show-raw-insn policies.o | sed -n "/<call_assume_valid/,/^$/p" | cut -f2-
+*   Both functions have the same instructions, apart from the addresses.
+*/
+
+#include "../../omm.h"
+#include "benchmark.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+#include <random>
+#include <vector>
+
+
+struct Shape{
+    virtual ~Shape(){}
+};
+
+struct Circle : Shape{};
+struct Rectangle : Shape{};
+
+// Not passed to WithDerivedTypes.
+struct Triangle : Shape{};
+
+
+// There is no implementation for (Rectangle,Rectangle), nor for the pairs with a Shape.
+struct overlap_implementations{
+
+    static int implementation(const Circle&, const Circle&){
+        return 1;
+    }
+
+    static int implementation(const Circle&, const Rectangle&){
+        return 2;
+    }
+
+    static int implementation(const Rectangle&, const Circle&){
+        return 3;
+    }
+
+};
+
+struct overlap_fallback{
+
+    static int fallback(const dispatch_error& error, const Shape&, const Shape&){
+        return error.kind == dispatch_error_kind::unknown_type ? -1 : -2;
+    }
+
+};
+
+using shapes = WithDerivedTypes<Circle,Rectangle>;
+
+template<typename... Options>
+using overlap_table = table_omm<WithImplementations<overlap_implementations>,
+                                WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                shapes,Options...>;
+
+using unchecked_table = overlap_table<>;
+using assume_valid_table = overlap_table<WithPolicy<assume_valid>>;
+using abort_table = overlap_table<WithPolicy<abort_on_error>>;
+using throw_table = overlap_table<WithPolicy<throw_on_error>>;
+using fallback_table = overlap_table<WithPolicy<call_fallback<overlap_fallback>>>;
+
+
+template<typename T, typename U>
+constexpr bool same_table(){
+    if (T::cells != U::cells || T::table_bytes != U::table_bytes)
+        return false;
+    for (int c = 0; c < T::cells; ++c)
+        if (T::table[c] != U::table[c] || T::keys[c] != U::keys[c])
+            return false;
+    return true;
+}
+
+static_assert(std::is_same<unchecked_table::TID,assume_valid_table::TID>::value,"assume_valid adds types to the table");
+static_assert(same_table<unchecked_table,assume_valid_table>(),"assume_valid changes the table");
+static_assert(fallback_table::cells > unchecked_table::cells,"The checked tables have a position for the unknown types");
+
+int call_without_policy(const Shape& a, const Shape& b){
+    return unchecked_table::call(a,b);
+}
+
+int call_assume_valid(const Shape& a, const Shape& b){
+    return assume_valid_table::call(a,b);
+}
+
+
+template<typename T>
+bool throws(const Shape& a, const Shape& b, dispatch_error_kind kind){
+    try{
+        T::call(a,b);
+    }
+    catch (const bad_dispatch& e){
+        return e.kind == kind;
+    }
+    return false;
+}
+
+template<typename T>
+bool aborts(const Shape& a, const Shape& b){
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0){
+        T::call(a,b);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child,&status,0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+
+int main(){
+
+    Circle circle;
+    Rectangle rectangle;
+    Triangle triangle;
+
+    bool ok = true;
+    ok = ok && throws<throw_table>(circle,triangle,dispatch_error_kind::unknown_type);
+    ok = ok && throws<throw_table>(rectangle,rectangle,dispatch_error_kind::missing_implementation);
+    ok = ok && throw_table::call(rectangle,circle) == 3;
+    ok = ok && fallback_table::call(triangle,circle) == -1;
+    ok = ok && fallback_table::call(rectangle,rectangle) == -2;
+    ok = ok && fallback_table::call(circle,rectangle) == 2;
+    ok = ok && aborts<abort_table>(circle,triangle);
+    ok = ok && aborts<abort_table>(rectangle,rectangle);
+    ok = ok && abort_table::call(circle,circle) == 1;
+    if (!ok){
+        std::printf("Error: a policy does not handle an invalid call\n");
+        return 1;
+    }
+
+    // Only valid calls, so the tables without checks can be timed too.
+    std::vector<std::pair<const Shape*,const Shape*>> pairs;
+    std::mt19937 generator(42);
+    const Shape* valid[3][2] = {{&circle,&circle},{&circle,&rectangle},{&rectangle,&circle}};
+    for (int i = 0; i < 4096; ++i){
+        auto& p = valid[generator()%3];
+        pairs.push_back({p[0],p[1]});
+    }
+
+    const long iterations = 20000000;
+    long results[5] = {0,0,0,0,0};
+    measure("without policy",iterations,[&](long i){
+        results[0] += unchecked_table::call(*pairs[i%pairs.size()].first,*pairs[i%pairs.size()].second);
+    });
+    measure("assume_valid",iterations,[&](long i){
+        results[1] += assume_valid_table::call(*pairs[i%pairs.size()].first,*pairs[i%pairs.size()].second);
+    });
+    measure("abort_on_error",iterations,[&](long i){
+        results[2] += abort_table::call(*pairs[i%pairs.size()].first,*pairs[i%pairs.size()].second);
+    });
+    measure("throw_on_error",iterations,[&](long i){
+        results[3] += throw_table::call(*pairs[i%pairs.size()].first,*pairs[i%pairs.size()].second);
+    });
+    measure("call_fallback",iterations,[&](long i){
+        results[4] += fallback_table::call(*pairs[i%pairs.size()].first,*pairs[i%pairs.size()].second);
+    });
+    do_not_optimize(results);
+
+    for (int k = 1; k < 5; ++k)
+        if (results[k] != results[0]){
+            std::printf("Error: the results are different\n");
+            return 1;
+        }
+
+    return 0;
+
+}
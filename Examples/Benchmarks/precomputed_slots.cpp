@@ -0,0 +1,89 @@
+/**
+*   Stores the slot of each shape of the Collisions benchmark once, next to the shapes (structure of
+*   arrays), and calls intersect with the cells computed from the stored slots. Compares it with
+*   table_omm::call, which identifies both shapes in every call.
+*
+*   Prints the time per call of both (the best of several runs).
+*
+*   Build: g++ -std=c++17 -O2 -DNDEBUG precomputed_slots.cpp -o precomputed_slots
+*
+*   Without -DNDEBUG, call_cell checks in every call that the cell matches the shapes.
+*/
+
+#include "Collisions/shapes.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/**
+*   The shapes and, in another array, the slot of each one in the first and second virtual argument.
+*   Both slots are the same because both arguments have the same list of types.
+*/
+struct shape_components{
+
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::vector<std::uint8_t> slots;
+
+    void add(std::unique_ptr<Shape> s){
+        slots.push_back(static_cast<std::uint8_t>(intersect_table::slot<0>(*s)));
+        shapes.push_back(std::move(s));
+    }
+};
+
+
+int main(){
+
+    static_assert(intersect_table::dimensions == 2,"intersect has two virtual arguments");
+    static_assert(intersect_table::slots<0> <= 256,"The slots must fit in a byte");
+
+    shape_components components;
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> position(0.0,8.0);
+    for (int i = 0; i < 4096; ++i){
+        double x = position(generator), y = position(generator);
+        switch (generator()%4){
+            case 0: components.add(std::make_unique<Ellipse>(x,y,0.5,0.3)); break;
+            case 1: components.add(std::make_unique<Circle>(x,y,0.4)); break;
+            case 2: components.add(std::make_unique<Rectangle>(x,y,0.3,0.6)); break;
+            default: components.add(std::make_unique<Triangle>(Point{x,y},Point{x+0.5,y},Point{x,y+0.5}));
+        }
+    }
+
+    std::vector<std::pair<int,int>> pairs;
+    for (int i = 0; i < 4096; ++i)
+        pairs.push_back({static_cast<int>(generator()%4096),static_cast<int>(generator()%4096)});
+
+    // The best of several runs, alternating both calls, so the noise and the order do not decide.
+    const long iterations = 5000000;
+    const int runs = 5;
+    long hits[2] = {0,0};
+    double best[2] = {1e9,1e9};
+    const char* names[2] = {"table_omm::call","table_omm::call_cell (stored slots)"};
+    for (int run = 0; run < runs; ++run){
+        hits[0] = hits[1] = 0;
+        best[0] = std::min(best[0],time_per_call(iterations,[&](long i){
+            auto p = pairs[i%pairs.size()];
+            hits[0] += intersect_table::call(*components.shapes[p.first],*components.shapes[p.second]);
+        }));
+        best[1] = std::min(best[1],time_per_call(iterations,[&](long i){
+            auto p = pairs[i%pairs.size()];
+            int cell = intersect_table::cell_of_slots(components.slots[p.first],components.slots[p.second]);
+            hits[1] += intersect_table::call_cell(cell,*components.shapes[p.first],*components.shapes[p.second]);
+        }));
+    }
+    for (int k = 0; k < 2; ++k)
+        std::printf("%-40s %8.2f ns\n",names[k],best[k]);
+    do_not_optimize(hits);
+
+    if (hits[0] != hits[1]){
+        std::printf("Error: call and call_cell do not find the same intersections\n");
+        return 1;
+    }
+
+    return 0;
+
+}
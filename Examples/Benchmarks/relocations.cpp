@@ -0,0 +1,103 @@
+/**
+*   Creates many omm tables to compare the encodings of the tables. With pointer_encoding every cell
+*   is a function pointer that needs a relocation when a position independent executable (or a shared
+*   object) is loaded, and the tables are written at startup. With index_encoding only the different
+*   functions of each table need relocations, and the cells are small integers in read-only memory.
+*   The tables use the default strategy (the decision tree, for these tables), whose levels store function
+*   pointers with any encoding, or the table strategy with TABLE_STRATEGY.
+*
+*   Build the versions:
+*       g++ -std=c++17 -O2 -fPIE -pie relocations.cpp -o relocations_pointers
+*       g++ -std=c++17 -O2 -fPIE -pie -DINDEX_ENCODING relocations.cpp -o relocations_indices
+*       g++ -std=c++17 -O2 -fPIE -pie -DTABLE_STRATEGY relocations.cpp -o relocations_pointers_table
+*       g++ -std=c++17 -O2 -fPIE -pie -DINDEX_ENCODING -DTABLE_STRATEGY relocations.cpp -o relocations_indices_table
+*
+*   Count the relocations and the size of the sections written at startup:
+*       readelf -r relocations_pointers | grep -c R_X86_64_RELATIVE
+*       size -A relocations_pointers | grep -E "data.rel.ro|^.rodata"
+*
+*   Compare the startup time:
+*       time (for i in $(seq 1000); do ./relocations_pointers > /dev/null; done)
+*/
+
+#include "../../omm.h"
+#include <cstdio>
+#include <utility>
+
+
+struct Node{
+    virtual ~Node(){}
+};
+
+template<int K>
+struct Leaf : Node{};
+
+/**
+*   The implementations of the method number M. Like most methods, it has much fewer implementations
+*   than cells: the first leaf decides, except for a pair of leaves.
+*/
+template<int M>
+struct method_implementations{
+
+    static int implementation(const Node& a, const Node& b){
+        return M;
+    }
+
+    template<int A>
+    static int implementation(const Leaf<A>& a, const Node& b){
+        return M + A;
+    }
+
+    static int implementation(const Leaf<1>& a, const Leaf<6>& b){
+        return M + 16;
+    }
+};
+
+#ifdef INDEX_ENCODING
+using encoding = WithEncoding<index_encoding>;
+#else
+using encoding = WithEncoding<pointer_encoding>;
+#endif
+
+#ifdef TABLE_STRATEGY
+using strategy = WithStrategy<table_strategy>;
+#else
+using strategy = WithStrategy<automatic_strategy>;
+#endif
+
+template<int M>
+using method_table = table_omm<WithImplementations<method_implementations<M>>,
+                               WithSignature<int(Virtual<const Node&>,Virtual<const Node&>)>,
+                               WithDerivedTypes<Leaf<0>,Leaf<1>,Leaf<2>,Leaf<3>,Leaf<4>,Leaf<5>,Leaf<6>,Leaf<7>>,
+                               strategy,
+                               encoding>;
+
+constexpr int methods = 64;
+
+template<int... MS>
+long call_all(std::integer_sequence<int,MS...>, const Node& a, const Node& b){
+    return (method_table<MS>::call(a,b) + ...);
+}
+
+template<int... MS>
+std::size_t bytes_all(std::integer_sequence<int,MS...>){
+    return (method_table<MS>::table_bytes + ...);
+}
+
+
+int main(int argc, char** argv){
+
+    Leaf<1> a;
+    Leaf<6> b;
+    const Node* nodes[] = {&a,&b};
+
+    // Every table is used, so all of them are in the program.
+    long result = call_all(std::make_integer_sequence<int,methods>{},*nodes[argc%2],*nodes[(argc+1)%2]);
+
+    using table = method_table<0>;
+    std::printf("encoding: %s  strategy: %s  tables: %d  cells per table: %d  functions per table: %d  table bytes: %zu  result: %ld\n",
+                table::layout.encoding,table::layout.strategy,methods,table::cells,table::thunks,bytes_all(std::make_integer_sequence<int,methods>{}),result);
+
+    return 0;
+
+}
@@ -0,0 +1,166 @@
+/**
+*   Compares calling a method over a std::vector<std::unique_ptr<Shape>> with calling it over
+*   a segmented_collection, using 1M shapes. It also checks methods whose tables do not have every type of
+*   the collection: the circles do not take part in them and are skipped.
+*
+*   Build: g++ -std=c++17 -O2 segmented_collection.cpp -o segmented_collection
+*/
+
+#include "../../omm_extras.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+struct Shape{
+    virtual ~Shape(){}
+};
+
+struct Circle : Shape{
+    Circle(double r) : r(r){}
+    double r;
+};
+
+struct Rectangle : Shape{
+    Rectangle(double w, double h) : w(w), h(h){}
+    double w, h;
+};
+
+struct Triangle : Shape{
+    Triangle(double b, double h) : b(b), h(h){}
+    double b, h;
+};
+
+
+struct area_implementations{
+
+    static void implementation(const Circle& c, double& total){
+        total += 3.14159*c.r*c.r;
+    }
+
+    static void implementation(const Rectangle& r, double& total){
+        total += r.w*r.h;
+    }
+
+    static void implementation(const Triangle& t, double& total){
+        total += t.b*t.h/2;
+    }
+
+};
+
+using shapes = WithDerivedTypes<Circle,Rectangle,Triangle>;
+
+using area_table = table_omm<WithImplementations<area_implementations>,
+                             WithSignature<void(Virtual<const Shape&>,double&)>,
+                             shapes>;
+
+// Only the polygons take part in these methods.
+struct sides_implementations{
+
+    static void implementation(const Rectangle&, long& total){
+        total += 4;
+    }
+
+    static void implementation(const Triangle&, long& total){
+        total += 3;
+    }
+
+    static void implementation(const Rectangle&, const Triangle&, long& total){
+        total += 1;
+    }
+
+    static void implementation(const Triangle&, const Rectangle&, long& total){
+        total += 2;
+    }
+
+    static void implementation(const Shape&, const Shape&, long&){}
+
+};
+
+using polygons = WithDerivedTypes<Rectangle,Triangle>;
+
+using sides_table = table_omm<WithImplementations<sides_implementations>,
+                              WithSignature<void(Virtual<const Shape&>,long&)>,
+                              polygons>;
+
+using polygon_pairs_table = table_omm<WithImplementations<sides_implementations>,
+                                      WithSignature<void(Virtual<const Shape&>,Virtual<const Shape&>,long&)>,
+                                      polygons,polygons>;
+
+
+int main(){
+
+    const int n = 1000000;
+    std::mt19937 generator(42);
+
+    std::vector<std::unique_ptr<Shape>> pointers;
+    segmented_collection<shapes> segments;
+    for (int i = 0; i < n; ++i){
+        double x = generator()%100;
+        switch (generator()%3){
+            case 0:
+                pointers.push_back(std::make_unique<Circle>(x));
+                segments.emplace<Circle>(x);
+                break;
+            case 1:
+                pointers.push_back(std::make_unique<Rectangle>(x,2));
+                segments.emplace<Rectangle>(x,2);
+                break;
+            default:
+                pointers.push_back(std::make_unique<Triangle>(x,2));
+                segments.emplace<Triangle>(x,2);
+                break;
+        }
+    }
+    std::shuffle(pointers.begin(),pointers.end(),generator);
+
+    const int iterations = 20;
+    double expected = 0;
+    double total = 0;
+
+    measure("vector<unique_ptr> + call (1M)",iterations,[&](long){
+        expected = 0;
+        for (auto& p : pointers)
+            area_table::call(*p,expected);
+    });
+
+    measure("segmented_collection::dispatch (1M)",iterations,[&](long){
+        total = 0;
+        segments.dispatch<area_table>(total);
+    });
+
+    if (std::abs(total-expected) > 1e-6*expected){
+        std::printf("Error: the results are different\n");
+        return 1;
+    }
+
+    long rectangles = 0, triangles = 0;
+    for (auto& p : pointers){
+        rectangles += dynamic_cast<Rectangle*>(p.get()) != nullptr;
+        triangles += dynamic_cast<Triangle*>(p.get()) != nullptr;
+    }
+    long sides = 0;
+    segments.dispatch<sides_table>(sides);
+    if (sides != 4*rectangles + 3*triangles){
+        std::printf("Error: the circles are not skipped by a method without them\n");
+        return 1;
+    }
+
+    segmented_collection<shapes> few;
+    few.emplace<Circle>(1);
+    few.emplace<Rectangle>(1,2);
+    few.emplace<Rectangle>(2,2);
+    few.emplace<Triangle>(1,2);
+    long pairs = 0;
+    few.dispatch_pairs<polygon_pairs_table>(few,pairs);
+    if (pairs != 2*1 + 2*2){
+        std::printf("Error: the circles are not skipped by a method on pairs without them\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,119 @@
+/**
+*   Prints, for several instantiations of add_vectors_table from the TemplateVectors example, the
+*   number of cells, the bytes used by the omm table, the number of intermediate functions (thunks)
+*   the table points to and the bytes of code of those thunks. C++ can not tell the size of a function,
+*   so the sizes are read from the symbol table of the program with nm (binutils), matching the
+*   addresses of the functions in the omm table. Without nm, or if the program is stripped, the code
+*   of the thunks is reported as unknown.
+*
+*   Build: g++ -std=c++17 -O2 size_report.cpp -o size_report
+*
+*   The largest thunks can be listed with:
+*       nm -C -S --size-sort size_report | grep make_function_cell_aux
+*/
+
+#include "../TemplateVectors/Vector.h"
+#include "../TemplateVectors/CanonVector.h"
+#include "../TemplateVectors/UnitVector.h"
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <unistd.h>
+
+
+extern "C" void size_report_anchor(){}
+
+/**
+*   Returns the size of every function of the program, by its address when the program is running.
+*   The addresses of nm are moved by the difference between the address of size_report_anchor
+*   and the one nm gives to it. Returns an empty map if nm can not be run.
+*/
+std::map<std::uintptr_t,std::size_t> function_sizes(){
+    std::map<std::uintptr_t,std::size_t> sizes;
+    // The shell run by popen has its own /proc/self/exe, so the path of the program is read first.
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe",path,sizeof(path)-1);
+    if (length <= 0)
+        return sizes;
+    path[length] = 0;
+    std::FILE* nm = popen(("nm -S --defined-only '" + std::string(path) + "' 2>/dev/null").c_str(),"r");
+    if (!nm)
+        return sizes;
+    std::uintptr_t anchor = 0;
+    char line[4096];
+    while (std::fgets(line,sizeof(line),nm)){
+        unsigned long long address, size;
+        char type;
+        char name[4000];
+        if (std::sscanf(line,"%llx %llx %c %3999s",&address,&size,&type,name) != 4)
+            continue;
+        sizes[address] = size;
+        if (std::string(name) == "size_report_anchor")
+            anchor = address;
+    }
+    pclose(nm);
+    if (!anchor)
+        return {};
+    std::map<std::uintptr_t,std::size_t> moved;
+    std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(&size_report_anchor) - anchor;
+    for (const auto& s : sizes)
+        moved[s.first+offset] = s.second;
+    return moved;
+}
+
+/**
+*   Returns the bytes of code of the thunks of an omm table, or -1 if some of them are not found.
+*   The thunks are counted like in count_thunks: the cells without function and the cells storing
+*   the implementation directly are skipped.
+*/
+template<typename Table>
+long thunk_bytes(const std::map<std::uintptr_t,std::size_t>& sizes){
+    constexpr int direct = position_v<typename Table::BS,typename Table::IMPL>;
+    std::set<std::uintptr_t> thunks;
+    for (int i = 0; i < Table::cells; ++i)
+        if (Table::table[i] != nullptr && !(direct >= 0 && Table::keys[i] == direct))
+            thunks.insert(reinterpret_cast<std::uintptr_t>(Table::table[i]));
+    long bytes = 0;
+    for (std::uintptr_t t : thunks){
+        auto s = sizes.find(t);
+        if (s == sizes.end())
+            return -1;
+        bytes += s->second;
+    }
+    return bytes;
+}
+
+template<typename T, unsigned int N>
+void report(const char* type, const std::map<std::uintptr_t,std::size_t>& sizes){
+    using table = add_vectors_table<T,N>;
+    long bytes = thunk_bytes<table>(sizes);
+    if (bytes < 0)
+        std::printf("add_vectors_table<%s,%u>  cells: %3d  table bytes: %4zu  thunks: %d  thunk bytes: unknown\n",
+                    type,N,table::cells,table::table_bytes,table::thunks);
+    else
+        std::printf("add_vectors_table<%s,%u>  cells: %3d  table bytes: %4zu  thunks: %d  thunk bytes: %4ld\n",
+                    type,N,table::cells,table::table_bytes,table::thunks,bytes);
+}
+
+template<typename T, unsigned int... NS>
+std::size_t report_all(const char* type, const std::map<std::uintptr_t,std::size_t>& sizes){
+    (report<T,NS>(type,sizes),...);
+    return (add_vectors_table<T,NS>::table_bytes + ...);
+}
+
+
+int main(){
+
+    std::map<std::uintptr_t,std::size_t> sizes = function_sizes();
+    std::size_t total = 0;
+    total += report_all<int,1,2,3,4,5,6,7,8,9,10>("int",sizes);
+    total += report_all<long,1,2,3,4,5,6,7,8,9,10>("long",sizes);
+    total += report_all<float,1,2,3,4,5,6,7,8,9,10>("float",sizes);
+    total += report_all<double,1,2,3,4,5,6,7,8,9,10>("double",sizes);
+    std::printf("Total table bytes: %zu\n",total);
+
+    return 0;
+
+}
@@ -0,0 +1,212 @@
+/**
+*   Counts the reference count operations of methods whose virtual parameters are smart pointers.
+*   The standard smart pointers can not report their atomic operations, so two checks are made:
+*    - counted_ptr is a shared pointer that counts every copy (an atomic increment, and an atomic
+*      decrement when the copy is destroyed). It is plugged into omm with a virtual_adapter
+*      specialization, like std::shared_ptr, so every copy made by omm would be counted.
+*    - The implementations read the use_count of the std::shared_ptr being dispatched. A copy alive
+*      during the call would make it greater than the number of owners of the caller.
+*   Then several threads call the methods over the same objects, so the cache lines of the counts
+*   bounce between the cores when the smart pointers are copied (passed by value), and finally a null
+*   smart pointer must throw std::bad_typeid, like a null raw pointer.
+*
+*   Build: g++ -std=c++17 -O2 -pthread smart_pointers.cpp -o smart_pointers
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+
+std::atomic<long> refcount_operations{0};
+
+/**
+*   A shared pointer that counts the reference count operations of its copies.
+*/
+template<typename P>
+struct counted_ptr{
+
+    counted_ptr(std::shared_ptr<P> p) : ptr(std::move(p)){}
+
+    counted_ptr(const counted_ptr& p) : ptr(p.ptr), copied(true){
+        ++refcount_operations;
+    }
+
+    counted_ptr& operator=(const counted_ptr& p) = delete;
+
+    ~counted_ptr(){
+        if (copied)
+            ++refcount_operations;
+    }
+
+    std::shared_ptr<P> ptr;
+    bool copied = false;
+};
+
+template<typename P>
+struct virtual_adapter<counted_ptr<P>> : std::true_type{
+    using pointee = P;
+    static P* get(const counted_ptr<P>& p){
+        return p.ptr.get();
+    }
+};
+
+
+// The shared pointer being dispatched, whose use_count is read by the implementations.
+const std::shared_ptr<const Shape>* current = nullptr;
+long use_count = 0;
+
+template<typename S>
+int area(const S* s, int result){
+    if (current)
+        use_count = current->use_count();
+    return result;
+}
+
+struct area_implementations{
+
+    static int implementation(const Shape* a){ return area(a,1); }
+    static int implementation(const Ellipse* a){ return area(a,2); }
+    static int implementation(const Circle* a){ return area(a,3); }
+    static int implementation(const Rectangle* a){ return area(a,4); }
+
+};
+
+using derived_shapes = WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>;
+
+using reference_table = table_omm<WithImplementations<area_implementations>,
+                                  WithSignature<int(Virtual<const std::shared_ptr<const Shape>&>)>,derived_shapes>;
+
+using value_table = table_omm<WithImplementations<area_implementations>,
+                              WithSignature<int(Virtual<std::shared_ptr<const Shape>>)>,derived_shapes>;
+
+using unique_table = table_omm<WithImplementations<area_implementations>,
+                               WithSignature<int(Virtual<const std::unique_ptr<const Shape>&>)>,derived_shapes>;
+
+using counted_table = table_omm<WithImplementations<area_implementations>,
+                                WithSignature<int(Virtual<const counted_ptr<const Shape>&>)>,derived_shapes>;
+
+using counted_value_table = table_omm<WithImplementations<area_implementations>,
+                                      WithSignature<int(Virtual<counted_ptr<const Shape>>)>,derived_shapes>;
+
+
+/**
+*   Calls a method over every shared pointer from several threads at once, and returns the time per call.
+*/
+template<typename Function>
+double threaded_time_per_call(int threads, long iterations, Function&& f){
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&,t]{
+            long result = 0;
+            for (long i = 0; i < iterations; ++i)
+                result += f(i+t);
+            do_not_optimize(result);
+        });
+    for (std::thread& w : workers)
+        w.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(end-start).count()/iterations;
+}
+
+
+int main(){
+
+    std::vector<std::shared_ptr<const Shape>> shared;
+    std::vector<std::unique_ptr<const Shape>> unique;
+    std::vector<counted_ptr<const Shape>> counted;
+    auto add = [&](auto shape){
+        using S = decltype(shape);
+        shared.push_back(std::make_shared<const S>());
+        unique.push_back(std::make_unique<const S>());
+        counted.push_back(counted_ptr<const Shape>(shared.back()));
+    };
+    std::mt19937 generator(42);
+    for (int i = 0; i < 64; ++i){
+        switch (generator()%4){
+            case 0:  add(Ellipse()); break;
+            case 1:  add(Circle()); break;
+            case 2:  add(Rectangle()); break;
+            default: add(Triangle()); break;
+        }
+    }
+
+    const long iterations = 1000000;
+    bool failed = false;
+
+    // Exact counts with counted_ptr.
+    auto count = [&](const char* name, auto dispatch){
+        refcount_operations = 0;
+        long result = 0;
+        measure(name,iterations,[&](long i){
+            result += dispatch(counted[i%counted.size()]);
+        });
+        do_not_optimize(result);
+        double per_call = static_cast<double>(refcount_operations)/iterations;
+        std::printf("%-40s refcount operations/call: %.2f\n","",per_call);
+        return per_call;
+    };
+
+    failed |= count("counted_ptr by reference, call",[](const counted_ptr<const Shape>& p){ return counted_table::call(p); }) != 0;
+    failed |= count("counted_ptr by reference, tree_call",[](const counted_ptr<const Shape>& p){ return counted_table::tree_call(p); }) != 0;
+    // The copy made by the caller to pass the pointer by value.
+    failed |= count("counted_ptr by value, call",[](const counted_ptr<const Shape>& p){ return counted_value_table::call(p); }) != 2;
+
+    // The use_count seen by the implementations. Each object is owned by shared and counted.
+    long wrong = 0;
+    for (const std::shared_ptr<const Shape>& p : shared){
+        current = &p;
+        int result = reference_table::call(p);
+        wrong += use_count != 2;
+        do_not_optimize(result);
+    }
+    current = nullptr;
+    for (const std::unique_ptr<const Shape>& p : unique){
+        int result = unique_table::call(p);
+        do_not_optimize(result);
+    }
+    if (wrong){
+        std::printf("Error: %ld shared pointers were copied during the call\n",wrong);
+        failed = true;
+    }
+
+    // Every thread calls the method over the same shared pointers.
+    int threads = std::max(2u,std::thread::hardware_concurrency());
+    std::printf("\n%d threads over the same %zu objects:\n",threads,shared.size());
+    std::printf("%-40s %8.2f ns\n","shared_ptr by reference",threaded_time_per_call(threads,iterations,[&](long i){
+        return reference_table::call(shared[i%shared.size()]);
+    }));
+    std::printf("%-40s %8.2f ns\n","shared_ptr by value",threaded_time_per_call(threads,iterations,[&](long i){
+        return value_table::call(shared[i%shared.size()]);
+    }));
+    std::printf("%-40s %8.2f ns\n","unique_ptr by reference",threaded_time_per_call(threads,iterations,[&](long i){
+        return unique_table::call(unique[i%unique.size()]);
+    }));
+
+    // A null smart pointer is not dereferenced.
+    bool thrown = false;
+    try{
+        reference_table::call(std::shared_ptr<const Shape>());
+    }
+    catch (const std::bad_typeid&){
+        thrown = true;
+    }
+    std::printf("\nnull shared_ptr throws std::bad_typeid: %s\n",thrown ? "yes" : "no");
+    failed |= !thrown;
+
+    if (failed){
+        std::printf("Error: unexpected reference count operations\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,181 @@
+/**
+*   Checks the automatic choice of the dispatch strategy. For several signatures, prints the layout
+*   chosen by table_omm and the time per call of table_call and tree_call, and whether the automatic
+*   strategy picked the faster one (or one within 15% of it).
+*
+*   Build: g++ -std=c++17 -O2 strategy.cpp -o strategy
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+long result = 0;
+
+// Dense: every pair of shapes has its own implementation.
+struct dense_implementations{
+    static void implementation(const Shape& a, const Shape& b){ result += 1; }
+    static void implementation(const Ellipse& a, const Ellipse& b){ result += 2; }
+    static void implementation(const Ellipse& a, const Rectangle& b){ result += 3; }
+    static void implementation(const Ellipse& a, const Triangle& b){ result += 4; }
+    static void implementation(const Circle& a, const Circle& b){ result += 5; }
+    static void implementation(const Circle& a, const Rectangle& b){ result += 6; }
+    static void implementation(const Circle& a, const Triangle& b){ result += 7; }
+    static void implementation(const Rectangle& a, const Ellipse& b){ result += 8; }
+    static void implementation(const Rectangle& a, const Rectangle& b){ result += 9; }
+    static void implementation(const Rectangle& a, const Triangle& b){ result += 10; }
+    static void implementation(const Triangle& a, const Ellipse& b){ result += 11; }
+    static void implementation(const Triangle& a, const Rectangle& b){ result += 12; }
+    static void implementation(const Triangle& a, const Triangle& b){ result += 13; }
+};
+
+using dense_table = table_omm<WithImplementations<dense_implementations>,
+                              WithSignature<void(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                              WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// Sparse: the animal decides most of the calls.
+struct sparse_implementations{
+    static void implementation(Animal* a, const Shape& s1, const Shape& s2){ result += 1; }
+    static void implementation(Cat* a, const Shape& s1, const Shape& s2){ result += 2; }
+    static void implementation(Dog* a, const Shape& s1, const Shape& s2){ result += 3; }
+    static void implementation(Dog* a, const Circle& s1, const Circle& s2){ result += 4; }
+};
+
+using sparse_table = table_omm<WithImplementations<sparse_implementations>,
+                               WithSignature<void(Virtual<Animal*>,Virtual<const Shape&>,Virtual<const Shape&>)>,
+                               WithDerivedTypes<Circle,Dog,Rectangle,Cat,Triangle,Ellipse>>;
+
+// One virtual argument.
+struct single_implementations{
+    static void implementation(const Shape& s){ result += 1; }
+    static void implementation(const Ellipse& s){ result += 2; }
+    static void implementation(const Rectangle& s){ result += 3; }
+    static void implementation(const Triangle& s){ result += 4; }
+};
+
+using single_table = table_omm<WithImplementations<single_implementations>,
+                               WithSignature<void(Virtual<const Shape&>)>,
+                               WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// The second shape only matters for circles.
+struct mixed_implementations{
+    static void implementation(const Shape& a, const Shape& b){ result += 1; }
+    static void implementation(const Rectangle& a, const Shape& b){ result += 2; }
+    static void implementation(const Triangle& a, const Shape& b){ result += 3; }
+    static void implementation(const Circle& a, const Shape& b){ result += 4; }
+    static void implementation(const Circle& a, const Circle& b){ result += 5; }
+};
+
+using mixed_table = table_omm<WithImplementations<mixed_implementations>,
+                              WithSignature<void(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                              WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+
+//---------------------------------------------------------------------------------
+
+const long iterations = 5000000;
+const int runs = 6;
+bool wrong_choice = false;
+
+/**
+*   Prints the layout of a table, measures both strategies and checks the automatic choice.
+*    - T : The omm table.
+*    - name : The name of the table.
+*    - f : Calls the table with the strategy S with the i-th input: f(S{},i).
+*/
+template<typename T, typename Function>
+void compare(const char* name, Function&& f){
+    const dispatch_layout& l = T::layout;
+    std::printf("%s\n",name);
+    std::printf("  strategy: %s  dimensions: %d  cells: %d  implementations: %d  thunks: %d  fill ratio: %.3f\n",
+                l.strategy,l.dimensions,l.cells,l.implementations,l.thunks,l.fill_ratio);
+    std::printf("  table bytes: %zu  tree bytes: %zu  estimated steps: table %.2f, tree %.2f\n",
+                l.table_bytes,l.tree_bytes,l.table_cost,l.tree_cost);
+
+    // The best of several runs, alternating the order, so the noise does not decide.
+    double table = 1e9, tree = 1e9;
+    long table_result = 0, tree_result = 0;
+    auto run_table = [&]{
+        result = 0;
+        table = std::min(table,time_per_call(iterations,[&](long i){ f(table_strategy{},i); }));
+        table_result = result;
+    };
+    auto run_tree = [&]{
+        result = 0;
+        tree = std::min(tree,time_per_call(iterations,[&](long i){ f(tree_strategy{},i); }));
+        tree_result = result;
+    };
+    for (int run = 0; run < runs; ++run){
+        if (run%2 == 0){
+            run_table();
+            run_tree();
+        }
+        else{
+            run_tree();
+            run_table();
+        }
+    }
+    if (table_result != tree_result){
+        std::printf("  Error: table_call and tree_call do not call the same implementations\n");
+        wrong_choice = true;
+    }
+    std::printf("  table_call: %.2f ns  tree_call: %.2f ns\n",table,tree);
+
+    bool is_tree = std::is_same<typename T::STRATEGY,tree_strategy>::value;
+    double chosen = is_tree ? tree : table;
+    bool good = chosen <= 1.15*std::min(table,tree);
+    std::printf("  automatic choice: %s\n\n",good ? "ok" : "slower");
+    if (!good)
+        wrong_choice = true;
+}
+
+template<typename T, typename... AS>
+void call_with(table_strategy, AS&&... as){
+    T::table_call(std::forward<AS>(as)...);
+}
+
+template<typename T, typename... AS>
+void call_with(tree_strategy, AS&&... as){
+    T::tree_call(std::forward<AS>(as)...);
+}
+
+
+int main(){
+
+    Dog dog; Cat cat;
+    Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    Animal* animals[] = {&dog,&cat};
+    const Shape* shapes[] = {&circle,&ellipse,&rectangle,&triangle};
+
+    struct arguments{ Animal* a; const Shape* s1; const Shape* s2; };
+    std::vector<arguments> inputs;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i)
+        inputs.push_back({animals[generator()%2],shapes[generator()%4],shapes[generator()%4]});
+    auto input = [&](long i) -> const arguments& { return inputs[i%inputs.size()]; };
+
+    compare<dense_table>("Dense, 2 virtual arguments",[&](auto s, long i){
+        call_with<dense_table>(s,*input(i).s1,*input(i).s2);
+    });
+    compare<sparse_table>("Sparse, 3 virtual arguments",[&](auto s, long i){
+        call_with<sparse_table>(s,input(i).a,*input(i).s1,*input(i).s2);
+    });
+    compare<single_table>("1 virtual argument",[&](auto s, long i){
+        call_with<single_table>(s,*input(i).s1);
+    });
+    compare<mixed_table>("Mixed, 2 virtual arguments",[&](auto s, long i){
+        call_with<mixed_table>(s,*input(i).s1,*input(i).s2);
+    });
+
+    if (wrong_choice){
+        std::printf("The automatic strategy was not the fastest in some signatures\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,144 @@
+/**
+*   Compares the intersect method of the Collisions benchmark, where both orders of every pair of shapes
+*   are written, with the same method declared with symmetric_table_omm, where only one order is written.
+*   Prints the cells, the thunks and the bytes of both tables and the time per call (the best of several
+*   runs), and checks that both find the same intersections. It also checks a symmetric table with a non-virtual
+*   argument, called directly and with segmented_collection::dispatch_pairs, where the pairs whose first type
+*   comes later in the table are passed swapped.
+*
+*   Build: g++ -std=c++17 -O2 symmetric.cpp -o symmetric
+*/
+
+#include "../../omm_extras.h"
+#include "Collisions/shapes.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+// One order of each pair. The mirrored implementations are derived by symmetric_table_omm.
+struct symmetric_intersect_implementations{
+
+    using I = intersect_implementations;
+
+    static bool implementation(const Shape& a, const Shape& b){ return I::implementation(a,b); }
+    static bool implementation(const Circle& a, const Circle& b){ return I::implementation(a,b); }
+    static bool implementation(const Circle& c, const Rectangle& r){ return I::implementation(c,r); }
+    static bool implementation(const Rectangle& a, const Rectangle& b){ return I::implementation(a,b); }
+    static bool implementation(const Triangle& a, const Triangle& b){ return I::implementation(a,b); }
+    static bool implementation(const Triangle& t, const Rectangle& r){ return I::implementation(t,r); }
+    static bool implementation(const Triangle& t, const Circle& c){ return I::implementation(t,c); }
+};
+
+using symmetric_intersect_table = symmetric_table_omm<WithImplementations<symmetric_intersect_implementations>,
+                                                      WithSignature<bool(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                                      WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// The same pairs, counting the intersections, for segmented_collection::dispatch_pairs.
+struct symmetric_count_implementations{
+
+    using I = intersect_implementations;
+
+    static void implementation(const Shape& a, const Shape& b, long& hits){ hits += I::implementation(a,b); }
+    static void implementation(const Circle& a, const Circle& b, long& hits){ hits += I::implementation(a,b); }
+    static void implementation(const Circle& c, const Rectangle& r, long& hits){ hits += I::implementation(c,r); }
+    static void implementation(const Rectangle& a, const Rectangle& b, long& hits){ hits += I::implementation(a,b); }
+    static void implementation(const Triangle& a, const Triangle& b, long& hits){ hits += I::implementation(a,b); }
+    static void implementation(const Triangle& t, const Rectangle& r, long& hits){ hits += I::implementation(t,r); }
+    static void implementation(const Triangle& t, const Circle& c, long& hits){ hits += I::implementation(t,c); }
+};
+
+using collision_types = WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>;
+
+using symmetric_count_table = symmetric_table_omm<WithImplementations<symmetric_count_implementations>,
+                                                  WithSignature<void(Virtual<const Shape&>,Virtual<const Shape&>,long&)>,
+                                                  collision_types>;
+
+template<typename T>
+void print_layout(const char* name){
+    std::printf("%-22s cells: %3d  thunks: %3d  table bytes: %4zu\n",name,T::cells,T::thunks,T::table_bytes);
+}
+
+
+int main(){
+
+    print_layout<intersect_table>("table_omm");
+    print_layout<symmetric_intersect_table>("symmetric_table_omm");
+
+    std::vector<std::unique_ptr<Shape>> shapes;
+    segmented_collection<collision_types> segments[2];
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> position(0.0,4.0);
+    for (int i = 0; i < 4096; ++i){
+        double x = position(generator), y = position(generator);
+        auto& s = segments[i%2];
+        switch (generator()%4){
+            case 0: shapes.push_back(std::make_unique<Ellipse>(s.emplace<Ellipse>(x,y,0.5,0.3))); break;
+            case 1: shapes.push_back(std::make_unique<Circle>(s.emplace<Circle>(x,y,0.4))); break;
+            case 2: shapes.push_back(std::make_unique<Rectangle>(s.emplace<Rectangle>(x,y,0.3,0.6))); break;
+            default: shapes.push_back(std::make_unique<Triangle>(s.emplace<Triangle>(Point{x,y},Point{x+0.5,y},Point{x,y+0.5})));
+        }
+    }
+
+    std::vector<std::pair<const Shape*,const Shape*>> pairs;
+    for (int i = 0; i < 4096; ++i)
+        pairs.push_back({shapes[generator()%4096].get(),shapes[generator()%4096].get()});
+
+    // The best of several runs, alternating the tables, so the noise does not decide.
+    const long iterations = 5000000;
+    const int runs = 5;
+    long hits[3] = {0,0,0};
+    double best[3] = {1e9,1e9,1e9};
+    const char* names[3] = {"table_omm::table_call","table_omm::tree_call","symmetric_table_omm::call"};
+    for (int run = 0; run < runs; ++run){
+        hits[0] = hits[1] = hits[2] = 0;
+        best[0] = std::min(best[0],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            hits[0] += intersect_table::table_call(*p.first,*p.second);
+        }));
+        best[1] = std::min(best[1],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            hits[1] += intersect_table::tree_call(*p.first,*p.second);
+        }));
+        best[2] = std::min(best[2],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            hits[2] += symmetric_intersect_table::call(*p.first,*p.second);
+        }));
+    }
+    for (int k = 0; k < 3; ++k)
+        std::printf("%-40s %8.2f ns\n",names[k],best[k]);
+    do_not_optimize(hits);
+
+    if (hits[0] != hits[2] || hits[1] != hits[2]){
+        std::printf("Error: the symmetric table does not find the same intersections\n");
+        return 1;
+    }
+
+    // Every pair of an even shape and an odd one, in both orders of the segments.
+    long expected = 0;
+    long counted_hits = 0;
+    for (std::size_t i = 0; i < shapes.size(); i += 2)
+        for (std::size_t j = 1; j < shapes.size(); j += 2){
+            expected += intersect_table::call(*shapes[i],*shapes[j]) + intersect_table::call(*shapes[j],*shapes[i]);
+            symmetric_count_table::call(*shapes[i],*shapes[j],counted_hits);
+            symmetric_count_table::call(*shapes[j],*shapes[i],counted_hits);
+        }
+    std::printf("%-40s %8ld of %ld\n","symmetric call intersections",counted_hits,expected);
+    if (counted_hits != expected){
+        std::printf("Error: the symmetric table with a non-virtual argument does not find the same intersections\n");
+        return 1;
+    }
+    long segmented_hits = 0;
+    segments[0].dispatch_pairs<symmetric_count_table>(segments[1],segmented_hits);
+    segments[1].dispatch_pairs<symmetric_count_table>(segments[0],segmented_hits);
+    std::printf("%-40s %8ld of %ld\n","segmented dispatch_pairs intersections",segmented_hits,expected);
+    if (segmented_hits != expected){
+        std::printf("Error: segmented_collection::dispatch_pairs does not find the same intersections\n");
+        return 1;
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,99 @@
+/**
+*   Measures the cost of OMM_TRACE. Build it with and without the trace and compare the time per call
+*   of table_call and tree_call (the best of several runs). With the trace, it also measures the time
+*   to take and decode a snapshot, prints the last calls, and checks that the call to a symmetric method is
+*   recorded in its cell.
+*
+*   Build both versions:
+*       g++ -std=c++17 -O2 -pthread trace.cpp -o trace_off
+*       g++ -std=c++17 -O2 -pthread -DOMM_TRACE trace.cpp -o trace_on
+*/
+
+#include "../../omm.h"
+#include "../Shapes and animals/shapes.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+
+struct shapes_implementations{
+    static int implementation(const Shape& a, const Shape& b){ return 1; }
+    static int implementation(const Circle& a, const Circle& b){ return 2; }
+    static int implementation(const Ellipse& a, const Rectangle& b){ return 3; }
+    static int implementation(const Rectangle& a, const Ellipse& b){ return 4; }
+    static int implementation(const Triangle& a, const Shape& b){ return 5; }
+};
+
+using shapes_table = table_omm<WithImplementations<shapes_implementations>,
+                               WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                               WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+// A symmetric method, whose calls are swapped when needed.
+struct intersect_implementations{
+    static int implementation(const Shape& a, const Shape& b){ return 1; }
+    static int implementation(const Circle& a, const Rectangle& b){ return 2; }
+};
+
+using intersect_table = symmetric_table_omm<WithImplementations<intersect_implementations>,
+                                            WithSignature<int(Virtual<const Shape&>,Virtual<const Shape&>)>,
+                                            WithDerivedTypes<Ellipse,Circle,Rectangle,Triangle>>;
+
+
+int main(){
+
+#ifdef OMM_TRACE
+    std::printf("OMM_TRACE: on, %d calls per thread\n",OMM_TRACE_CAPACITY);
+#else
+    std::printf("OMM_TRACE: off\n");
+#endif
+
+    Shape shape; Circle circle; Ellipse ellipse; Rectangle rectangle; Triangle triangle;
+    const Shape* shapes[] = {&shape,&circle,&ellipse,&rectangle,&triangle};
+    std::vector<std::pair<const Shape*,const Shape*>> pairs;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i)
+        pairs.push_back({shapes[generator()%5],shapes[generator()%5]});
+
+    // The best of several runs, so the noise does not decide.
+    const long iterations = 10000000;
+    long results[2] = {0,0};
+    double best[2] = {1e9,1e9};
+    for (int run = 0; run < 5; ++run){
+        best[0] = std::min(best[0],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            results[0] += shapes_table::table_call(*p.first,*p.second);
+        }));
+        best[1] = std::min(best[1],time_per_call(iterations,[&](long i){
+            auto& p = pairs[i%pairs.size()];
+            results[1] += shapes_table::tree_call(*p.first,*p.second);
+        }));
+    }
+    // The last call, to a symmetric method, with its arguments swapped.
+    results[0] += intersect_table::call(rectangle,circle);
+    results[1] += intersect_table::call(rectangle,circle);
+    std::printf("%-40s %8.2f ns\n","table_call",best[0]);
+    std::printf("%-40s %8.2f ns\n","tree_call",best[1]);
+    do_not_optimize(results);
+
+#ifdef OMM_TRACE
+    auto start = std::chrono::steady_clock::now();
+    std::vector<dispatch_trace_record> records = dispatch_trace_snapshot();
+    double ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+    std::printf("snapshot of %zu calls: %.2f ms  timestamps per ns: %.3f\n\n",records.size(),ms,dispatch_ticks_per_ns());
+    report_dispatch_trace(8,stdout);
+    // Only this thread called the table, and its ring is full.
+    if (records.size() != OMM_TRACE_CAPACITY){
+        std::printf("Error: the snapshot has %zu of %d calls\n",records.size(),OMM_TRACE_CAPACITY);
+        return 1;
+    }
+    if (records.back().cell != intersect_table::cell_of(circle,rectangle)){
+        std::printf("Error: the last call is not in the cell of the symmetric method\n");
+        return 1;
+    }
+#endif
+
+    return results[0] == results[1] ? 0 : 1;
+
+}
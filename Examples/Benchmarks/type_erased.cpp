@@ -0,0 +1,146 @@
+/**
+*   Compares dispatching messages stored in a std::any with a chain of std::any_cast against
+*   dispatching them with table_omm, using std::any and a custom type-erased handle as virtual types.
+*
+*   Build: g++ -std=c++17 -O2 type_erased.cpp -o type_erased
+*/
+
+#include "../../omm_extras.h"
+#include "benchmark.h"
+#include <any>
+#include <random>
+#include <string>
+#include <vector>
+
+
+struct Move{ int dx, dy; };
+struct Attack{ int target, damage; };
+struct Heal{ int amount; };
+struct Chat{ int channel; };
+struct Join{ int player; };
+struct Leave{ int player; };
+
+
+/**
+*   A handle that does not own the message. It stores the type_info of the message, so the
+*   cast to the message type does not need any check.
+*/
+struct message_handle{
+
+    template<typename M>
+    message_handle(M& m) : type(&typeid(M)), data(&m){}
+
+    const std::type_info* type;
+    void* data;
+};
+
+template<>
+struct virtual_adapter<message_handle> : std::true_type{
+
+    using pointee = message_handle;
+
+    template<typename D>
+    using holds = std::true_type;
+
+    static const std::type_info& type_id(const message_handle& h) noexcept{
+        return *h.type;
+    }
+
+    template<typename D>
+    static D* get(const message_handle& h) noexcept{
+        return static_cast<D*>(h.data);
+    }
+};
+
+
+long result = 0;
+
+struct handle_implementations{
+
+    static void implementation(const Move* m){ result += m->dx + m->dy; }
+    static void implementation(const Attack* a){ result += a->damage; }
+    static void implementation(const Heal* h){ result += h->amount; }
+    static void implementation(const Chat* c){ result += c->channel; }
+    static void implementation(const Join* j){ result += j->player; }
+    static void implementation(const Leave* l){ result -= l->player; }
+
+    // Any other message.
+    static void implementation(const std::any* a){}
+    static void implementation(const message_handle* h){}
+
+};
+
+using messages = WithDerivedTypes<Move,Attack,Heal,Chat,Join,Leave>;
+
+using any_table = table_omm<WithImplementations<handle_implementations>,
+                            WithSignature<void(Virtual<const std::any&>)>,
+                            messages>;
+
+using handle_table = table_omm<WithImplementations<handle_implementations>,
+                               WithSignature<void(Virtual<const message_handle&>)>,
+                               messages>;
+
+
+void any_cast_chain(const std::any& a){
+    if (auto m = std::any_cast<Move>(&a))
+        handle_implementations::implementation(m);
+    else if (auto t = std::any_cast<Attack>(&a))
+        handle_implementations::implementation(t);
+    else if (auto h = std::any_cast<Heal>(&a))
+        handle_implementations::implementation(h);
+    else if (auto c = std::any_cast<Chat>(&a))
+        handle_implementations::implementation(c);
+    else if (auto j = std::any_cast<Join>(&a))
+        handle_implementations::implementation(j);
+    else if (auto l = std::any_cast<Leave>(&a))
+        handle_implementations::implementation(l);
+    else
+        handle_implementations::implementation(&a);
+}
+
+
+int main(){
+
+    Move move{1,2}; Attack attack{3,4}; Heal heal{5}; Chat chat{6}; Join join{7}; Leave leave{8};
+
+    std::vector<std::any> anys;
+    std::vector<message_handle> handles;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 4096; ++i){
+        switch (generator()%6){
+            case 0: anys.emplace_back(move); handles.emplace_back(move); break;
+            case 1: anys.emplace_back(attack); handles.emplace_back(attack); break;
+            case 2: anys.emplace_back(heal); handles.emplace_back(heal); break;
+            case 3: anys.emplace_back(chat); handles.emplace_back(chat); break;
+            case 4: anys.emplace_back(join); handles.emplace_back(join); break;
+            default: anys.emplace_back(leave); handles.emplace_back(leave); break;
+        }
+    }
+
+    const long iterations = 20000000;
+
+    result = 0;
+    measure("any_cast chain",iterations,[&](long i){
+        any_cast_chain(anys[i%anys.size()]);
+    });
+    long expected = result;
+
+    result = 0;
+    measure("table_omm::call (std::any)",iterations,[&](long i){
+        any_table::call(anys[i%anys.size()]);
+    });
+    long any_result = result;
+
+    result = 0;
+    measure("table_omm::call (message_handle)",iterations,[&](long i){
+        handle_table::call(handles[i%handles.size()]);
+    });
+
+    if (any_result != expected || result != expected){
+        std::printf("Error: the results are different\n");
+        return 1;
+    }
+
+    return 0;
+
+}
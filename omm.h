@@ -4,6 +4,47 @@
 #include <typeinfo>
 #include <type_traits>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#if defined(OMM_PERF_COUNTERS) || defined(OMM_LATENCY_HISTOGRAMS)
+#include <deque>
+#include <mutex>
+#endif
+
+#if defined(OMM_TRACE) || defined(OMM_LATENCY_HISTOGRAMS) || defined(OMM_PERF_COUNTERS)
+#include <thread>
+#endif
+
+#if defined(OMM_TRACE) || defined(OMM_LATENCY_HISTOGRAMS)
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef OMM_PERF_COUNTERS
+#include <cstring>
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
 
 /**
  This library allows the programmer to use open multi-methods.
@@ -83,6 +124,20 @@
                  * Example: tlist<tlist<void,Derived1*,int,SomeClass,const Derived2&>,tlist<void,Derived1*,int,SomeClass,const Derived3&>>
 
         - table_omm: It is an array of pointers to the implementations.
+
+    Besides the omm table, two more lists are computed from DSCOMB. They are used to know which
+    cells call the same implementation:
+
+        - IMPL (Implementations): It is a list containing the signatures from DSCOMB that are exactly
+               the signature of some implementation.
+                 * Example: tlist<tlist<void,Derived1*,int,SomeClass,const Base2&>>
+
+        - keys: It is an array with an integer per cell of the omm table. It is the position in IMPL of the
+               implementation that the cell calls, or -1 if it is not in IMPL (or the cell has no implementation).
+               The cells for unknown types (see the dispatch policies) have the key -2.
+               The keys are computed placing each implementation from IMPL in the cells it accepts, so the overload
+               resolution is only done for the cells where no implementation from IMPL is the most specific one.
+               Defining OMM_PER_CELL_RESOLUTION, the overload resolution is done for every cell instead.
 */
 
 //---------------------------------------------------------------------------------
@@ -189,6 +244,24 @@ using sub1_t = typename sub1<T>::type;
 template<typename T>
 static constexpr int sub1_v = sub1<T>::value;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Performs the product of several numbers.
+*    - TS... : Each number is an int_constant type.
+*/
+template<typename... TS>
+struct multiply : one{};
+
+template<typename T, typename... TS>
+struct multiply<T,TS...> : int_constant<T::value*multiply<TS...>::value>{};
+
+template<typename... TS>
+using multiply_t = typename multiply<TS...>::type;
+
+template<typename... TS>
+static constexpr int multiply_v = multiply<TS...>::value;
+
 
 //---------------------------------------------------------------------------------
 //--------------------------------- COLLECTION ------------------------------------
@@ -267,7 +340,8 @@ using tlist_t = typename tlist<TS...>::type;
 //---------------------------------------------------------------------------------
 
 /**
-*   Transforms a tlist into a collection.
+*   Transforms a tlist into a collection. Every step creates a longer collection, so eight types are moved
+*   at once while possible: the long lists (like DSCOMB) would create too many long collections otherwise.
 *    - T : The list to turn into a collection.
 */
 template<typename L, typename C>
@@ -279,6 +353,11 @@ struct tlist_to_collection_aux<nil,C> : C{};
 template<typename T, typename R, typename... S>
 struct tlist_to_collection_aux<cons<T,R>,collection<S...>> : tlist_to_collection_aux<R,collection<S...,T>>{};
 
+template<typename T0, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+         typename R, typename... S>
+struct tlist_to_collection_aux<cons<T0,cons<T1,cons<T2,cons<T3,cons<T4,cons<T5,cons<T6,cons<T7,R>>>>>>>>,collection<S...>>
+    : tlist_to_collection_aux<R,collection<S...,T0,T1,T2,T3,T4,T5,T6,T7>>{};
+
 template<typename T>
 struct tlist_to_collection : tlist_to_collection_aux<T,collection<>>{};
 
@@ -531,6 +610,32 @@ struct flip{
     using type = typename P<S,T>::type;
 };
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the position of a type in a list. If the type is not in the list, returns -1.
+*    - T : The type to look for.
+*    - L : The list where T is looked for.
+*/
+template<typename T, typename L>
+struct position : int_constant<-1>{};
+
+template<typename T, typename S>
+struct position<T,cons<T,S>> : zero{};
+
+template<typename T, typename U, typename S>
+struct position<T,cons<U,S>>{
+    static constexpr int next = position<T,S>::value;
+    using type = int_constant<(next < 0 ? -1 : next+1)>;
+    static constexpr int value = type::value;
+};
+
+template<typename T, typename L>
+using position_t = typename position<T,L>::type;
+
+template<typename T, typename L>
+static constexpr int position_v = position<T,L>::value;
+
 
 //---------------------------------------------------------------------------------
 //-------------------------------- virtual_type -----------------------------------
@@ -548,11 +653,105 @@ struct virtual_type{
 //---------------------------------------------------------------------------------
 
 /**
-*   Checks whether a type is a pointer or a reference to a polymorphic type.
+*   Checks whether a type is a virtual_type.
+*    - T : The type to check.
+*/
+template<typename T>
+struct is_virtual_type : std::false_type{};
+
+template<typename T>
+struct is_virtual_type<virtual_type<T>> : std::true_type{};
+
+template<typename T>
+static constexpr bool is_virtual_type_v = is_virtual_type<T>::value;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Describes the types that are neither pointers nor references but give access to an object,
+*   like smart pointers. They can be used as virtual types too. Each specialization contains the
+*   type of the object (pointee) and a function that returns a raw pointer to it (get).
+*    - T : The type to describe.
+*/
+template<typename T>
+struct virtual_adapter : std::false_type{};
+
+template<typename P>
+struct virtual_adapter<std::shared_ptr<P>> : std::true_type{
+    using pointee = P;
+    static P* get(const std::shared_ptr<P>& p){
+        return p.get();
+    }
+};
+
+template<typename P, typename Del>
+struct virtual_adapter<std::unique_ptr<P,Del>> : std::true_type{
+    using pointee = P;
+    static P* get(const std::unique_ptr<P,Del>& p){
+        return p.get();
+    }
+};
+
+template<typename T>
+using virtual_adapter_of = virtual_adapter<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a type is a type-erased adapter (or a reference to it). Type-erased adapters, like
+*   std::any (see omm_extras.h), give access to an object whose type is not derived from a common base.
+*   Instead of a raw pointer to a base type, their specializations of virtual_adapter contain:
+*    - pointee : The adapter itself. It is used as the base type in the omm table.
+*    - holds<D> : Tells whether the adapter can contain an object of type D from the DCL.
+*    - type_id : Returns the type_info of the object contained in the adapter.
+*    - get<D> : Returns a raw pointer to the contained object, knowing that its type is D. The pointer
+*               keeps the cv qualifiers of the adapter.
+*   The objects whose type is not in the DCL are treated like the adapter itself.
+*    - T : The type to check.
+*/
+template<typename A, typename = void>
+struct is_erased_adapter_aux : std::false_type{};
+
+template<typename A>
+struct is_erased_adapter_aux<A,std::void_t<decltype(&A::type_id)>> : std::true_type{};
+
+template<typename T>
+struct is_erased_adapter : is_erased_adapter_aux<virtual_adapter_of<T>>{};
+
+template<typename T>
+using is_erased_adapter_t = typename is_erased_adapter<T>::type;
+
+template<typename T>
+static constexpr bool is_erased_adapter_v = is_erased_adapter<T>::value;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a type is an adapter (or a reference to an adapter) to a polymorphic type, or a type-erased adapter.
+*    - T : The type to check.
+*/
+template<typename IsAdapter, typename T>
+struct is_polymorphic_adapter_aux : std::false_type{};
+
+template<typename T>
+struct is_polymorphic_adapter_aux<std::true_type,T> : std::bool_constant<std::is_polymorphic<typename virtual_adapter_of<T>::pointee>::value ||
+                                                                          is_erased_adapter<T>::value>{};
+
+template<typename T>
+struct is_polymorphic_adapter : is_polymorphic_adapter_aux<typename virtual_adapter_of<T>::type,T>{};
+
+template<typename T>
+using is_polymorphic_adapter_t = typename is_polymorphic_adapter<T>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a type is a pointer, a reference or an adapter to a polymorphic type.
 *    - T : The type to check.
 */
 template<typename T>
-struct is_polymorphic_pr : or_type<std::is_polymorphic_t<std::remove_pointer_t<T>>,std::is_polymorphic_t<std::remove_reference_t<T>>>{};
+struct is_polymorphic_pr : or_type<std::is_polymorphic_t<std::remove_pointer_t<T>>,std::is_polymorphic_t<std::remove_reference_t<T>>,
+                                   is_polymorphic_adapter_t<T>>{};
 
 template<typename T>
 using is_polymorphic_pr_t = typename is_polymorphic_pr<T>::type;
@@ -560,20 +759,60 @@ using is_polymorphic_pr_t = typename is_polymorphic_pr<T>::type;
 template<typename T>
 static constexpr bool is_polymorphic_pr_v = is_polymorphic_pr<T>::value;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Represents a virtual parameter whose value, instead of its type, participates in the multiple
+*   dispatch. Each value has its own row in the omm table, and the rest of values share the first one.
+*   The implementations receive a std::integral_constant for the values listed, or the value itself.
+*    - E : The type of the value. It must be an enum or an integral type.
+*    - VS... : The values that have their own row in the omm table.
+*/
+template<typename E, E... VS>
+struct enum_value{
+    static_assert(std::is_enum<E>::value || std::is_integral<E>::value,"The type of an enum_value must be an enum or an integral type");
+    using type = enum_value<E,VS...>;
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a type is an enum_value.
+*    - T : The type to check.
+*/
+template<typename T>
+struct is_enum_value : std::false_type{};
+
+template<typename E, E... VS>
+struct is_enum_value<enum_value<E,VS...>> : std::true_type{};
+
+template<typename T>
+static constexpr bool is_enum_value_v = is_enum_value<T>::value;
+
 
 //---------------------------------------------------------------------------------
 //-------------------------- Type related metafunctions ---------------------------
 //---------------------------------------------------------------------------------
 
 /**
-*   Removes references, pointers and cv qualifiers from a type.
+*   Removes references, pointers and cv qualifiers from a type. Adapters are turned into the core
+*   form of their pointee, except the type-erased ones.
 *    - T : The type to be turned into a core form.
 */
-template<typename IsRef, typename IsPtr, typename T>
-struct core_type_aux{
+template<typename T>
+struct core_type;
+
+template<typename IsAdapter, typename T>
+struct core_type_adapter{
     using type = std::remove_cv_t<T>;
 };
 
+template<typename T>
+struct core_type_adapter<std::true_type,T> : core_type<typename virtual_adapter_of<T>::pointee>{};
+
+template<typename IsRef, typename IsPtr, typename T>
+struct core_type_aux : core_type_adapter<std::bool_constant<virtual_adapter_of<T>::value && !is_erased_adapter<T>::value>,T>{};
+
 template<typename IsPtr, typename T>
 struct core_type_aux<std::true_type,IsPtr,T> : core_type_aux<std::is_reference_t<std::remove_cv_t<std::remove_reference_t<T>>>,
                                                              std::is_pointer_t<std::remove_cv_t<std::remove_reference_t<T>>>,
@@ -646,6 +885,36 @@ struct slice_type{
 template<typename N, typename S>
 using slice_type_t = typename slice_type<N,S>::type;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the type of a parameter of an implementation from the type of a virtual parameter and
+*   the derived type that replaces its base type. Adapters are turned into raw pointers, so the
+*   implementations receive a pointer to the derived type. Type-erased adapters keep their own cv
+*   qualifiers. The enum_value in the first position of its list in TID is turned into the type of its values.
+*    - T : The type of the virtual parameter.
+*    - D : The derived type.
+*/
+template<typename IsAdapter, typename IsErased, typename T, typename D>
+struct derived_argument_aux : slice_type<T,D>{};
+
+template<typename T, typename D>
+struct derived_argument_aux<std::true_type,std::false_type,T,D> : slice_type<std::add_pointer_t<typename virtual_adapter_of<T>::pointee>,D>{};
+
+template<typename T, typename D>
+struct derived_argument_aux<std::true_type,std::true_type,T,D> : slice_type<std::add_pointer_t<std::remove_reference_t<T>>,D>{};
+
+template<typename T, typename D>
+struct derived_argument : derived_argument_aux<typename virtual_adapter_of<T>::type,is_erased_adapter_t<T>,T,D>{};
+
+template<typename E, E... VS>
+struct derived_argument<enum_value<E,VS...>,enum_value<E,VS...>>{
+    using type = E;
+};
+
+template<typename T, typename D>
+using derived_argument_t = typename derived_argument<T,D>::type;
+
 
 //---------------------------------------------------------------------------------
 //------------------------- VBS (Virtual Base Signature) --------------------------
@@ -705,12 +974,105 @@ struct vbsign_to_bsign<nil> : nil{};
 template<typename B, typename BS>
 struct vbsign_to_bsign<cons<virtual_type<B>,BS>> : cons<B,typename vbsign_to_bsign<BS>::type>{};
 
+template<typename E, E... VS, typename BS>
+struct vbsign_to_bsign<cons<virtual_type<enum_value<E,VS...>>,BS>> : cons<E,typename vbsign_to_bsign<BS>::type>{};
+
 template<typename B, typename BS>
 struct vbsign_to_bsign<cons<B,BS>> : cons<B,typename vbsign_to_bsign<BS>::type>{};
 
 template<typename VBS>
 using vbsign_to_bsign_t = typename vbsign_to_bsign<VBS>::type;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the signature of the functions stored in the cells (CS) from a VBS. It is the BS, except that
+*   the parameters that are not virtual and receive a class by value receive it by rvalue reference: the
+*   argument is only moved (or copied) once, into the parameter of the implementation (see cell_argument).
+*    - VBS : The VBS type.
+*/
+template<typename B>
+struct cell_parameter{
+    using type = std::conditional_t<std::is_class<B>::value,B&&,B>;
+};
+
+template<typename B>
+struct cell_parameter<B&>{
+    using type = B&;
+};
+
+template<typename B>
+struct cell_parameter<B&&>{
+    using type = B&&;
+};
+
+template<typename PS>
+struct cell_parameters : nil{};
+
+template<typename B, typename PS>
+struct cell_parameters<cons<virtual_type<B>,PS>> : cons<car_t<vbsign_to_bsign_t<tlist_t<virtual_type<B>>>>,typename cell_parameters<PS>::type>{};
+
+template<typename B, typename PS>
+struct cell_parameters<cons<B,PS>> : cons<typename cell_parameter<B>::type,typename cell_parameters<PS>::type>{};
+
+template<typename VBS>
+struct vbsign_to_csign : cons<car_t<VBS>,typename cell_parameters<cdr_t<VBS>>::type>{};
+
+template<typename VBS>
+using vbsign_to_csign_t = typename vbsign_to_csign<VBS>::type;
+
+/**
+*   Passes an argument to a parameter of a cell. B is the type of the parameter in the BS. If it receives
+*   a class by value, an rvalue of that class is passed as it is, and any other argument initializes a
+*   temporary, as the parameter would do. The rest of arguments are forwarded.
+*    - B : The type of the parameter in the BS.
+*/
+template<typename IsByValue, typename B>
+struct cell_argument_aux{
+    template<typename A>
+    static A&& call(A&& a) noexcept{
+        return std::forward<A>(a);
+    }
+};
+
+template<typename B>
+struct cell_argument_aux<std::true_type,B>{
+
+    static B&& call(B&& b) noexcept{
+        return std::move(b);
+    }
+
+    template<typename A>
+    static B call(A&& a) noexcept(std::is_nothrow_constructible<B,A>::value){
+        return std::forward<A>(a);
+    }
+};
+
+template<typename B>
+struct cell_argument : cell_argument_aux<std::bool_constant<std::is_class<B>::value>,B>{};
+
+/**
+*   Calls the function of a cell, whose signature is the CS, with the arguments of a call (see cell_argument).
+*    - BS : The BS type.
+*/
+template<typename BC>
+struct cell_call_aux{};
+
+template<typename R, typename... Bargs>
+struct cell_call_aux<collection<R,Bargs...>>{
+
+    template<typename FP, typename... AS>
+    static constexpr bool nothrow = noexcept(std::declval<FP>()(cell_argument<Bargs>::call(std::declval<AS>())...));
+
+    template<typename FP, typename... AS>
+    static R call(FP f, AS&&... as) noexcept(nothrow<FP,AS...>){
+        return f(cell_argument<Bargs>::call(std::forward<AS>(as))...);
+    }
+};
+
+template<typename BS>
+struct cell_call : cell_call_aux<tlist_to_collection_t<BS>>{};
+
 
 //---------------------------------------------------------------------------------
 //------------------------------------- TID ---------------------------------------
@@ -718,11 +1080,28 @@ using vbsign_to_bsign_t = typename vbsign_to_bsign<VBS>::type;
 
 /**
 *   Creates a list whose first element is a base type and the rest of elements are derived types from the DCL.
+*   If the base type is an enum_value, the rest of elements are its values as std::integral_constant.
+*   If it is a type-erased adapter, the rest of elements are the types from the DCL it can contain.
 *    - B : The base type that will be the first element of the list.
 *    - DCL : The DCL type.
 */
+template<typename B>
+struct erased_adapter_holds_c{
+    template<typename D>
+    using type = typename virtual_adapter<B>::template holds<D>::type;
+};
+
+template<typename IsErased, typename B, typename DCL>
+struct create_base_of_many_aux : cons<B,remove_if_not_t<std::is_base_of_c<B>::template type,DCL>>{};
+
 template<typename B, typename DCL>
-struct create_base_of_many : cons<B,remove_if_not_t<std::is_base_of_c<B>::template type,DCL>>{};
+struct create_base_of_many_aux<std::true_type,B,DCL> : cons<B,remove_if_not_t<erased_adapter_holds_c<B>::template type,DCL>>{};
+
+template<typename B, typename DCL>
+struct create_base_of_many : create_base_of_many_aux<is_erased_adapter_t<B>,B,DCL>{};
+
+template<typename E, E... VS, typename DCL>
+struct create_base_of_many<enum_value<E,VS...>,DCL> : tlist<enum_value<E,VS...>,std::integral_constant<E,VS>...>{};
 
 template<typename B, typename DCL>
 using create_base_of_many_t = typename create_base_of_many<B,DCL>::type;
@@ -746,6 +1125,53 @@ struct create_type_id : mapcar<create_base_of_many_c_inv<DCL>::template type,BCL
 template<typename BCL, typename DCL>
 using create_type_id_t = typename create_type_id<BCL,DCL>::type;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Represents the types that are not in a list from TID. When the omm table checks the types of
+*   the objects (see the dispatch policies), unknown_type is added at the end of each list, so the
+*   objects whose type is not listed are sent to the cells with unknown_type. The lists of enum_values
+*   and type-erased adapters do not need it, as the unknown values are treated like the first element.
+*/
+struct unknown_type{};
+
+template<typename IsErased, typename T>
+struct add_unknown_type_aux : append<T,tlist_t<unknown_type>>{};
+
+template<typename T>
+struct add_unknown_type_aux<std::true_type,T> : T{};
+
+template<typename T>
+struct add_unknown_type : add_unknown_type_aux<is_erased_adapter_t<car_t<T>>,T>{};
+
+template<typename E, E... VS, typename S>
+struct add_unknown_type<cons<enum_value<E,VS...>,S>> : cons<enum_value<E,VS...>,S>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Adds unknown_type to every list from TID if the types of the objects are checked.
+*    - Checked : A bool_constant indicating whether the types are checked.
+*    - TID : The TID type.
+*/
+template<typename Checked, typename TID>
+struct add_unknown_types : TID{};
+
+template<typename TID>
+struct add_unknown_types<std::true_type,TID> : mapcar<add_unknown_type,TID>{};
+
+template<typename Checked, typename TID>
+using add_unknown_types_t = typename add_unknown_types<Checked,TID>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a signature contains unknown_type.
+*    - DS : The signature.
+*/
+template<typename DS>
+struct has_unknown_type : std::bool_constant<(position_v<unknown_type,mapcar_t<core_type,DS>> >= 0)>{};
+
 
 //---------------------------------------------------------------------------------
 //----------------------------------- Indices -------------------------------------
@@ -813,6 +1239,21 @@ struct make_indices : apply<cartesian_product,mapcar_t<less_numbers,mapcar_t<len
 template<typename TID>
 using make_indices_t = typename make_indices<TID>::type;
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the number of cells of an omm table, i.e. the product of the lengths of the lists in TID.
+*    - TID : The TID type.
+*/
+template<typename TID>
+struct table_length : apply<multiply,mapcar_t<length,TID>>{};
+
+template<typename TID>
+using table_length_t = typename table_length<TID>::type;
+
+template<typename TID>
+static constexpr int table_length_v = table_length<TID>::value;
+
 
 //---------------------------------------------------------------------------------
 //------------------------------------- DCOMB -------------------------------------
@@ -867,8 +1308,11 @@ struct vbsign_to_dsign{};
 template<typename VBS>
 struct vbsign_to_dsign<VBS,nil> : VBS{};
 
+template<typename T, typename S>
+struct vbsign_to_dsign<cons<T,S>,nil> : cons<T,S>{};
+
 template<typename T, typename S, typename DL>
-struct vbsign_to_dsign<cons<virtual_type<T>,S>,DL> : cons<slice_type_t<T,car_t<DL>>,typename vbsign_to_dsign<S,cdr_t<DL>>::type>{};
+struct vbsign_to_dsign<cons<virtual_type<T>,S>,DL> : cons<derived_argument_t<T,car_t<DL>>,typename vbsign_to_dsign<S,cdr_t<DL>>::type>{};
 
 template<typename T, typename S, typename DL>
 struct vbsign_to_dsign<cons<T,S>,DL> : cons<T,typename vbsign_to_dsign<S,DL>::type>{};
@@ -930,6 +1374,42 @@ using signature_to_function_type_t = typename signature_to_function_type<L>::typ
 
 //---------------------------------------------------------------------------------
 
+/**
+*   Returns the function type that can be called with the same arguments, but that is noexcept.
+*    - T : The function type.
+*/
+template<typename T>
+struct add_noexcept{};
+
+template<typename R, typename... AS>
+struct add_noexcept<R(AS...)>{
+    using type = R(AS...) noexcept;
+};
+
+template<typename T>
+using add_noexcept_t = typename add_noexcept<T>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a cell of the omm table cannot throw, i.e. it is a pointer to a noexcept function
+*   (or it has no function at all).
+*    - P : The type of the cell.
+*/
+template<typename P>
+struct is_nothrow_cell : std::false_type{};
+
+template<>
+struct is_nothrow_cell<std::nullptr_t> : std::true_type{};
+
+template<typename R, typename... AS>
+struct is_nothrow_cell<R(*)(AS...) noexcept> : std::true_type{};
+
+template<typename P>
+static constexpr bool is_nothrow_cell_v = is_nothrow_cell<std::decay_t<P>>::value;
+
+//---------------------------------------------------------------------------------
+
 /**
 *   Taken from https://stackoverflow.com/questions/28309164/checking-for-existence-of-an-overloaded-member-function
 *   Checks whether an implementation exists inside the struct with all the implementations.
@@ -967,190 +1447,3971 @@ static constexpr bool has_implementation_v = has_implementation<F,CD>::value;
 //---------------------------------------------------------------------------------
 
 /**
-*   Generates a function pointer that calls a specific implementation method after doing a cast.
-*    - F: The struct containing all the implementations.
-*    - BS: A tlist containing the signature of the returned function pointer.
-*    - DS: A tlist containing the signature of the specific implementation method.
+*   Casts an argument received by a cell of the omm table to the type expected by the implementation.
+*   If the argument is an adapter, the raw pointer is retrieved first. Type-erased adapters return the
+*   pointer to the contained object, or to themselves if the implementation receives the base type. Values of an enum_value are
+*   turned into their std::integral_constant. The rest of arguments keep their value category, so rvalue
+*   references are cast to rvalue references and the parameters taken by value are moved, not copied.
+*    - D : The type of the parameter of the implementation.
+*    - B : The type of the parameter of the cell.
+*    - b : The argument to cast.
 */
-template<typename HasImplementation, typename F, typename BC, typename DC>
-struct make_function_cell_aux{};
-
-template<typename F, typename R, typename... Bargs, typename... Dargs>
-struct make_function_cell_aux<std::false_type,F,collection<R,Bargs...>,collection<R,Dargs...>>{
-    static constexpr std::nullptr_t value = nullptr;
+template<typename IsAdapter, typename D, typename B>
+struct argument_cast_aux{
+    static D call(B&& b) noexcept(noexcept(static_cast<D>(std::forward<B>(b)))){
+        return static_cast<D>(std::forward<B>(b));
+    }
 };
 
-template<typename F, typename R, typename... Bargs, typename... Dargs>
-struct make_function_cell_aux<std::true_type,F,collection<R,Bargs...>,collection<R,Dargs...>>{
-    static R value(Bargs... args){
-        return F::implementation(static_cast<Dargs>(args)...);
+template<typename D, typename B>
+struct argument_cast_aux<std::true_type,D,B>{
+    static D call(B&& b) noexcept(noexcept(static_cast<D>(virtual_adapter_of<B>::get(b)))){
+        return static_cast<D>(virtual_adapter_of<B>::get(b));
     }
 };
 
-template<typename F, typename BS, typename DS>
-struct make_function_cell : make_function_cell_aux<has_implementation_t<F,tlist_to_collection_t<DS>>,
-                                                   F,tlist_to_collection_t<BS>,tlist_to_collection_t<DS>>{};
-
-//---------------------------------------------------------------------------------
-
-/**
-*   Creates the omm table.
-*    - F : The struct containing all the implementations.
-*    - BS : The BS type.
-*    - DSCOMB : The DSCOMB type.
-*/
-template<typename F, typename BS, typename DSCOMB>
-struct create_omm_table_aux{};
+template<typename IsBase, typename D, typename B>
+struct erased_argument_cast{
+    static D call(B&& b) noexcept(noexcept(virtual_adapter_of<B>::template get<core_type_t<D>>(b))){
+        return virtual_adapter_of<B>::template get<core_type_t<D>>(b);
+    }
+};
 
-template<typename F, typename BS, typename... DS>
-struct create_omm_table_aux<F,BS,collection<DS...>>{
-    static constexpr std::add_pointer_t<signature_to_function_type_t<BS>> value[] = {make_function_cell<F,BS,DS>::value...};
+template<typename D, typename B>
+struct erased_argument_cast<std::true_type,D,B>{
+    static D call(B&& b) noexcept{
+        return std::addressof(b);
+    }
 };
 
-template<typename F, typename BS, typename DSCOMB>
-struct create_omm_table : create_omm_table_aux<F,BS,tlist_to_collection_t<DSCOMB>>{};
+template<typename D, typename B>
+struct argument_cast : std::conditional_t<is_erased_adapter<B>::value && std::is_pointer<D>::value,
+                                          erased_argument_cast<typename std::is_same<core_type_t<D>,core_type_t<B>>::type,D,B>,
+                                          argument_cast_aux<std::bool_constant<virtual_adapter_of<B>::value && !virtual_adapter_of<D>::value>,D,B>>{};
 
-template<typename F, typename BS, typename DSCOMB>
-static constexpr auto create_omm_table_v = create_omm_table<F,BS,DSCOMB>::value;
+template<typename E, E V>
+struct argument_cast<std::integral_constant<E,V>,E>{
+    static std::integral_constant<E,V> call(E&&) noexcept{
+        return {};
+    }
+};
 
 
 //---------------------------------------------------------------------------------
-//---------------------------------- Get index ------------------------------------
+//------------------------------ Latency histograms -------------------------------
+//---------------------------------------------------------------------------------
+
+#if defined(OMM_TRACE) || defined(OMM_LATENCY_HISTOGRAMS)
+
+/**
+*   The timestamps of OMM_TRACE and OMM_LATENCY_HISTOGRAMS: the time stamp counter in x86, or the
+*   nanoseconds of steady_clock.
+*/
+inline std::uint64_t dispatch_timestamp() noexcept{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+*   A timestamp and the time when it was taken, to convert the timestamps to nanoseconds. It is taken
+*   when the first ring or histogram is created.
+*/
+struct dispatch_clock_origin{
+
+    std::uint64_t timestamp = dispatch_timestamp();
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+    static const dispatch_clock_origin& instance(){
+        static const dispatch_clock_origin origin;
+        return origin;
+    }
+};
+
+/**
+*   The timestamps per nanosecond, measured since the origin.
+*/
+inline double dispatch_ticks_per_ns(){
+    const dispatch_clock_origin& origin = dispatch_clock_origin::instance();
+    double ns = std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-origin.time).count();
+    std::uint64_t ticks = dispatch_timestamp()-origin.timestamp;
+    return ns > 0.0 && ticks > 0 ? ticks/ns : 1.0;
+}
+
+#endif
+
+#ifdef OMM_LATENCY_HISTOGRAMS
+
+inline std::string type_name(const std::type_info& info);
+
+/**
+*   Describes an implementation whose calls are timed.
+*/
+struct latency_implementation{
+    std::string (*name)();
+};
+
+/**
+*   The times of the calls to an implementation in a thread, in buckets of powers of two: the bucket b
+*   counts the calls that took between 2^b and 2^(b+1) timestamps (the last one, the longer calls).
+*   Only the thread that owns it writes it, so relaxed atomics are enough for other threads to read it.
+*/
+struct latency_histogram{
+
+    static constexpr int buckets = 32;
+
+    std::atomic<const latency_implementation*> implementation{nullptr};
+    std::atomic<std::uint64_t> counts[buckets] = {};
+    std::atomic<std::uint64_t> ticks{0};
+
+    static int bucket(std::uint64_t t) noexcept{
+        int b = 0;
+        for (int shift = 32; shift > 0; shift >>= 1)
+            if (t >> shift){
+                t >>= shift;
+                b += shift;
+            }
+        return b < buckets ? b : buckets-1;
+    }
+
+    void add(std::uint64_t t) noexcept{
+        std::atomic<std::uint64_t>& count = counts[bucket(t)];
+        count.store(count.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+        ticks.store(ticks.load(std::memory_order_relaxed)+t,std::memory_order_relaxed);
+    }
+};
+
+/**
+*   Describes a method whose calls are timed per cell.
+*    - name : The struct with the implementations and the signature of the omm table.
+*    - cell_name : The signature of a cell, taken from DSCOMB.
+*    - cells : The number of cells.
+*    - direct : Whether it only counts the cells called directly, see implementation_latency.
+*/
+struct latency_method{
+    std::string (*name)();
+    std::string (*cell_name)(int cell);
+    int cells;
+    bool direct;
+};
+
+/**
+*   Keeps the histograms of every method in every thread. They are never removed, so they survive the
+*   threads that created them.
+*/
+struct latency_registry{
+
+    struct entry{
+        entry(const latency_method* method, std::thread::id thread)
+            : method(method), thread(thread), histograms(new latency_histogram[method->cells]){}
+        const latency_method* method;
+        std::thread::id thread;
+        std::unique_ptr<latency_histogram[]> histograms;
+    };
+
+    std::mutex mutex;
+    std::deque<entry> entries;
+
+    latency_registry(){
+        dispatch_clock_origin::instance();
+    }
+
+    latency_histogram* add(const latency_method* method){
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.emplace_back(method,std::this_thread::get_id());
+        return entries.back().histograms.get();
+    }
+
+    static latency_registry& instance(){
+        static latency_registry* registry = new latency_registry;
+        return *registry;
+    }
+};
+
+/**
+*   The histogram of the cell being called by the current thread. It is set by table_call and tree_call
+*   before calling the function of the cell, and taken by the thunk of the implementation.
+*/
+inline latency_histogram*& latency_current_cell() noexcept{
+    static thread_local latency_histogram* cell = nullptr;
+    return cell;
+}
+
+/**
+*   Sets the cell being called while a call lasts.
+*/
+struct latency_attribution{
+
+    latency_attribution(latency_histogram* cell) noexcept{
+        latency_current_cell() = cell;
+    }
+
+    ~latency_attribution(){
+        latency_current_cell() = nullptr;
+    }
+};
+
+template<typename DSCOMB>
+struct latency_signature_names;
+
+template<typename... DS>
+struct latency_signature_names<collection<DS...>>{
+    static std::vector<std::string> call(){
+        return {type_name(typeid(signature_to_function_type_t<DS>))...};
+    }
+};
+
+inline std::string latency_method_name(const std::type_info& f, const std::type_info& signature){
+    return type_name(f) + " " + type_name(signature);
+}
+
+/**
+*   The histograms of the cells of a method in the current thread, created in the first call of each
+*   thread.
+*    - F : The struct containing all the implementations.
+*    - BS : The BS type.
+*    - DSCOMB : The DSCOMB type.
+*/
+template<typename F, typename BS, typename DSCOMB>
+struct method_latency{
+
+    static std::string name(){
+        return latency_method_name(typeid(F),typeid(signature_to_function_type_t<BS>));
+    }
+
+    static std::string cell_name(int cell){
+        static const std::vector<std::string> names = latency_signature_names<tlist_to_collection_t<DSCOMB>>::call();
+        return cell >= 0 && cell < static_cast<int>(names.size()) ? names[cell] : "?";
+    }
+
+    static constexpr latency_method method = {&name,&cell_name,length_v<DSCOMB>,false};
+
+    static latency_histogram* local(){
+        static thread_local latency_histogram* histograms = nullptr;
+        if (!histograms)
+            histograms = latency_registry::instance().add(&method);
+        return histograms;
+    }
+};
+
+/**
+*   The histogram of the calls to an implementation from the functions of the cells, when the cell is not
+*   known (the cells called directly, see cell).
+*    - F : The struct containing all the implementations.
+*    - BC : The signature of the function of the cell as a collection.
+*    - DC : The signature of the implementation as a collection.
+*/
+template<typename F, typename BC, typename DC>
+struct implementation_latency{
+
+    static std::string name(){
+        return latency_method_name(typeid(F),typeid(collection_to_function_type_t<BC>));
+    }
+
+    static std::string cell_name(int){
+        return "(cells called directly)";
+    }
+
+    static std::string implementation_name(){
+        return type_name(typeid(collection_to_function_type_t<DC>));
+    }
+
+    static constexpr latency_method method = {&name,&cell_name,1,true};
+    static constexpr latency_implementation implementation = {&implementation_name};
+
+    static latency_histogram* local(){
+        static thread_local latency_histogram* histogram = nullptr;
+        if (!histogram)
+            histogram = latency_registry::instance().add(&method);
+        return histogram;
+    }
+};
+
+/**
+*   Times a call to an implementation. The time goes to the histogram of the cell being called, or to
+*   the histogram of the implementation if the cell is not known.
+*    - I : The implementation_latency of the implementation.
+*/
+template<typename I>
+struct latency_timer{
+
+    latency_histogram* histogram;
+    std::uint64_t start;
+
+    // Not noexcept: the histogram of the implementation is created in the first call of each thread.
+    latency_timer() : histogram(latency_current_cell()){
+        if (histogram)
+            latency_current_cell() = nullptr;
+        else
+            histogram = I::local();
+        histogram->implementation.store(&I::implementation,std::memory_order_relaxed);
+        start = dispatch_timestamp();
+    }
+
+    ~latency_timer(){
+        histogram->add(dispatch_timestamp()-start);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The calls to a cell (or to an implementation from the cells called directly) merged over the threads.
+*   The times are in timestamps, see dispatch_ticks_per_ns.
+*    - cell : The cell, or -1 for the cells called directly.
+*    - implementation : The signature of the implementation called by the cell.
+*    - counts : The calls in each bucket of latency_histogram.
+*/
+struct latency_histogram_record{
+
+    std::string method;
+    int cell;
+    std::string cell_signature;
+    std::string implementation;
+    std::uint64_t counts[latency_histogram::buckets];
+    std::uint64_t calls;
+    std::uint64_t ticks;
+
+    // Estimates the time below which a fraction q of the calls took, interpolating inside its bucket.
+    double percentile(double q) const{
+        double rank = q*calls;
+        std::uint64_t below = 0;
+        for (int b = 0; b < latency_histogram::buckets; ++b){
+            if (counts[b] && below+counts[b] >= rank){
+                double low = b ? static_cast<double>(std::uint64_t(1) << b) : 0.0;
+                double high = static_cast<double>(std::uint64_t(2) << b);
+                return low + (high-low)*(rank-below)/counts[b];
+            }
+            below += counts[b];
+        }
+        return 0.0;
+    }
+};
+
+/**
+*   Query and report API:
+*    - latency_histogram_snapshot : Returns the histograms of every cell that was called, merged over the
+*      threads and sorted by method and cell.
+*    - reset_latency_histograms : Empties the histograms. The calls that finish while they are emptied
+*      may be kept.
+*    - report_latency_histograms : Prints the cells that took more time in total, with their calls, the
+*      mean time and the estimated 50th and 99th percentiles.
+*   The cells called through cell do not know their cell, so they are merged per implementation.
+*/
+inline std::vector<latency_histogram_record> latency_histogram_snapshot(){
+    latency_registry& registry = latency_registry::instance();
+    std::vector<std::pair<std::pair<const latency_method*,int>,latency_histogram_record>> merged;
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (latency_registry::entry& e : registry.entries)
+        for (int cell = 0; cell < e.method->cells; ++cell){
+            latency_histogram& h = e.histograms[cell];
+            const latency_implementation* implementation = h.implementation.load(std::memory_order_relaxed);
+            if (!implementation)
+                continue;
+            auto key = std::make_pair(e.method,cell);
+            auto m = std::find_if(merged.begin(),merged.end(),[&](auto& p){ return p.first == key; });
+            if (m == merged.end()){
+                latency_histogram_record r{e.method->name(),e.method->direct ? -1 : cell,e.method->cell_name(cell),implementation->name(),{},0,0};
+                m = merged.insert(merged.end(),{key,r});
+            }
+            latency_histogram_record& r = m->second;
+            for (int b = 0; b < latency_histogram::buckets; ++b){
+                std::uint64_t count = h.counts[b].load(std::memory_order_relaxed);
+                r.counts[b] += count;
+                r.calls += count;
+            }
+            r.ticks += h.ticks.load(std::memory_order_relaxed);
+        }
+    std::vector<latency_histogram_record> records;
+    for (auto& m : merged)
+        records.push_back(m.second);
+    std::stable_sort(records.begin(),records.end(),[](const latency_histogram_record& a, const latency_histogram_record& b){
+        return a.method != b.method ? a.method < b.method : a.cell < b.cell;
+    });
+    return records;
+}
+
+inline void reset_latency_histograms(){
+    latency_registry& registry = latency_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (latency_registry::entry& e : registry.entries)
+        for (int cell = 0; cell < e.method->cells; ++cell){
+            latency_histogram& h = e.histograms[cell];
+            for (std::atomic<std::uint64_t>& count : h.counts)
+                count.store(0,std::memory_order_relaxed);
+            h.ticks.store(0,std::memory_order_relaxed);
+        }
+}
+
+inline void report_latency_histograms(std::size_t count = 32, std::FILE* out = stderr){
+    std::vector<latency_histogram_record> records = latency_histogram_snapshot();
+    std::stable_sort(records.begin(),records.end(),[](const latency_histogram_record& a, const latency_histogram_record& b){
+        return a.ticks > b.ticks;
+    });
+    double rate = dispatch_ticks_per_ns();
+    for (std::size_t i = 0; i < records.size() && i < count; ++i){
+        const latency_histogram_record& r = records[i];
+        if (!r.calls)
+            continue;
+        std::fprintf(out,"%s  cell %d: %s -> %s\n",r.method.c_str(),r.cell,r.cell_signature.c_str(),r.implementation.c_str());
+        std::fprintf(out,"    calls %llu  total %.3f ms  mean %.1f ns  p50 %.1f ns  p99 %.1f ns\n",static_cast<unsigned long long>(r.calls),
+                     r.ticks/rate/1e6,r.ticks/rate/r.calls,r.percentile(0.5)/rate,r.percentile(0.99)/rate);
+    }
+}
+
+#endif // OMM_LATENCY_HISTOGRAMS
+
+/**
+*   With OMM_LATENCY_HISTOGRAMS, the functions of the cells time the implementations, which allocates
+*   memory in the first call of each thread (see latency_timer), so they can throw std::bad_alloc.
+*/
+#ifdef OMM_LATENCY_HISTOGRAMS
+static constexpr bool nothrow_cell_instrumentation = false;
+#else
+static constexpr bool nothrow_cell_instrumentation = true;
+#endif
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Generates a function pointer that calls a specific implementation method after doing a cast.
+*   The function is noexcept if the implementation and the casts are noexcept (and it is not timed).
+*    - F: The struct containing all the implementations.
+*    - BS: A tlist containing the signature of the returned function pointer.
+*    - DS: A tlist containing the signature of the specific implementation method.
+*/
+template<typename HasImplementation, typename F, typename BC, typename DC>
+struct make_function_cell_aux{};
+
+template<typename F, typename R, typename... Bargs, typename... Dargs>
+struct make_function_cell_aux<std::false_type,F,collection<R,Bargs...>,collection<R,Dargs...>>{
+    static constexpr std::nullptr_t value = nullptr;
+};
+
+template<typename F, typename R, typename... Bargs, typename... Dargs>
+struct make_function_cell_aux<std::true_type,F,collection<R,Bargs...>,collection<R,Dargs...>>{
+    static constexpr bool nothrow = noexcept(F::implementation(argument_cast<Dargs,Bargs>::call(std::declval<Bargs>())...)) &&
+                                    nothrow_cell_instrumentation;
+    static R function(Bargs... args) noexcept(nothrow){
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_timer<implementation_latency<F,collection<R,Bargs...>,collection<R,Dargs...>>> timer;
+#endif
+        return F::implementation(argument_cast<Dargs,Bargs>::call(std::forward<Bargs>(args))...);
+    }
+    static constexpr std::add_pointer_t<R(Bargs...) noexcept(nothrow)> value = &function;
+};
+
+template<typename F, typename BS, typename DS>
+struct make_function_cell : make_function_cell_aux<has_implementation_t<F,tlist_to_collection_t<DS>>,
+                                                   F,tlist_to_collection_t<BS>,tlist_to_collection_t<DS>>{};
+
+
+//---------------------------------------------------------------------------------
+//------------------------------- Dispatch policies -------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns a readable name of a type. The name is demangled if the compiler allows it.
+*    - info : The type_info of the type.
+*/
+inline std::string type_name(const std::type_info& info){
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.name(),nullptr,nullptr,&status);
+    if (status == 0 && demangled){
+        std::string name = demangled;
+        std::free(demangled);
+        return name;
+    }
+#endif
+    return info.name();
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Describes an invalid call to a method:
+*    - unknown_type : The type of some object is not in the list passed to WithDerivedTypes.
+*    - missing_implementation : There is no implementation for the types of the objects (or it is ambiguous).
+*   The signature is the one of the omm table for unknown types, or the one of the cell for missing implementations.
+*/
+enum class dispatch_error_kind{
+    unknown_type,
+    missing_implementation
+};
+
+struct dispatch_error{
+
+    dispatch_error_kind kind;
+    const std::type_info& signature;
+
+    std::string message() const{
+        if (kind == dispatch_error_kind::unknown_type)
+            return "omm: unknown type in a call to " + type_name(signature);
+        else
+            return "omm: no implementation for " + type_name(signature);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Exception thrown by the policy throw_on_error.
+*/
+struct bad_dispatch : std::runtime_error{
+
+    dispatch_error_kind kind;
+
+    bad_dispatch(const dispatch_error& error) : std::runtime_error(error.message()), kind(error.kind){}
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The policies indicate what to do when a call is invalid. Their member checked tells whether the calls
+*   are checked. If they are, every cell that would be invalid calls the static function handle of the policy:
+*    - assume_valid : The calls are not checked. The omm table is the same as without policy.
+*    - abort_on_error : Prints the error and calls std::abort.
+*    - throw_on_error : Throws a bad_dispatch exception.
+*    - call_fallback<G> : Returns G::fallback(error,args...), where args are the arguments of the call.
+*   As the invalid cells are stored in the omm table, checking the calls does not add any branch.
+*/
+struct assume_valid{
+    using checked = std::false_type;
+};
+
+struct abort_on_error{
+
+    using checked = std::true_type;
+
+    template<typename R, typename... AS>
+    [[noreturn]] static R handle(const dispatch_error& error, AS&&...) noexcept{
+        std::fprintf(stderr,"%s\n",error.message().c_str());
+        std::abort();
+    }
+};
+
+struct throw_on_error{
+
+    using checked = std::true_type;
+
+    template<typename R, typename... AS>
+    [[noreturn]] static R handle(const dispatch_error& error, AS&&...){
+        throw bad_dispatch(error);
+    }
+};
+
+template<typename G>
+struct call_fallback{
+
+    using checked = std::true_type;
+
+    template<typename R, typename... AS>
+    static R handle(const dispatch_error& error, AS&&... as) noexcept(noexcept(G::fallback(error,std::forward<AS>(as)...))){
+        return G::fallback(error,std::forward<AS>(as)...);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Generates a function pointer that calls the policy.
+*    - P : The policy.
+*    - K : The kind of error.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - S : The signature described by the error.
+*/
+template<typename P, dispatch_error_kind K, typename BC, typename S>
+struct error_cell_aux{};
+
+template<typename P, dispatch_error_kind K, typename R, typename... Bargs, typename S>
+struct error_cell_aux<P,K,collection<R,Bargs...>,S>{
+    static constexpr bool nothrow = noexcept(P::template handle<R>(std::declval<const dispatch_error&>(),std::declval<Bargs>()...));
+    static R function(Bargs... args) noexcept(nothrow){
+        return P::template handle<R>(dispatch_error{K,typeid(signature_to_function_type_t<S>)},std::forward<Bargs>(args)...);
+    }
+    static constexpr std::add_pointer_t<R(Bargs...) noexcept(nothrow)> value = &function;
+};
+
+template<typename P, dispatch_error_kind K, typename BS, typename S>
+struct error_cell : error_cell_aux<P,K,tlist_to_collection_t<BS>,S>{};
+
+
+//---------------------------------------------------------------------------------
+//--------------------------- Implementation resolution ---------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether the struct with all the implementations has an implementation whose signature
+*   is exactly the given one.
+*    - F: The struct containing all the implementations.
+*    - CS: A collection representing the signature to look for.
+*/
+template<typename F, typename CS, typename = void>
+struct has_exact_implementation : std::false_type{};
+
+template<typename F, typename R, typename... Sargs>
+struct has_exact_implementation<F,collection<R,Sargs...>,std::void_t<decltype(static_cast<R(*)(Sargs...)>(&F::implementation))>> : std::true_type{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether the implementation whose signature is exactly the given one is noexcept.
+*    - F: The struct containing all the implementations.
+*    - CS: A collection representing the signature of the implementation.
+*/
+template<typename F, typename CS, typename = void>
+struct has_nothrow_implementation : std::false_type{};
+
+template<typename F, typename R, typename... Sargs>
+struct has_nothrow_implementation<F,collection<R,Sargs...>,std::void_t<decltype(static_cast<R(*)(Sargs...) noexcept>(&F::implementation))>> : std::true_type{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Adds to the struct with all the implementations a new one whose signature is exactly CS. The new
+*   implementation hides the original one, so the overload resolution selects the new one if and only if
+*   it would select the original one. The returned tag tells us that.
+*    - F: The struct containing all the implementations.
+*    - CS: A collection representing the signature of the implementation to probe.
+*/
+struct selected_implementation_tag{};
+
+template<typename F, typename CS>
+struct implementation_probe{};
+
+template<typename F, typename R, typename... Sargs>
+struct implementation_probe<F,collection<R,Sargs...>> : F{
+    using F::implementation;
+    static selected_implementation_tag implementation(Sargs...);
+};
+
+/**
+*   Returns the type returned by the implementation that the overload resolution selects for the arguments
+*   AS of a probe P, or void if the call is not valid (there is no implementation, or it is ambiguous).
+*   The probes can add the ellipsis to tell when there is no implementation.
+*    - P : The probe (see implementation_probe).
+*    - AC : A collection with the types of the arguments.
+*/
+struct no_implementation_tag{};
+
+template<typename P, typename AC, typename = void>
+struct next_probe_result{
+    using type = void;
+};
+
+template<typename P, typename... AS>
+struct next_probe_result<P,collection<AS...>,std::void_t<decltype(P::implementation(std::declval<AS>()...))>>{
+    using type = decltype(P::implementation(std::declval<AS>()...));
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether the implementation with signature CS is the one called when the arguments
+*   have the types in CD.
+*    - F: The struct containing all the implementations.
+*    - CS: A collection representing the signature of the implementation.
+*    - CD: A collection representing the signature of a cell of the omm table.
+*/
+template<typename F, typename CS, typename CD, typename = void>
+struct selects_implementation : std::false_type{};
+
+template<typename F, typename CS, typename R, typename... Dargs>
+struct selects_implementation<F,CS,collection<R,Dargs...>,
+                              std::enable_if_t<std::is_same<decltype(implementation_probe<F,CS>::implementation(std::declval<Dargs>()...)),
+                                                            selected_implementation_tag>::value>> : std::true_type{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the position in IMPL of the implementation called when the arguments have the types in CD.
+*   If that implementation is not in IMPL, returns -1.
+*    - F: The struct containing all the implementations.
+*    - IMPL: The IMPL type.
+*    - CD: A collection representing the signature of a cell of the omm table.
+*/
+template<typename F, typename IMPL, typename CD>
+struct selected_implementation_position : int_constant<-1>{};
+
+template<typename IsSelected, typename F, typename IMPL, typename CD>
+struct selected_implementation_position_aux : zero{};
+
+template<typename F, typename IMPL, typename CD>
+struct selected_implementation_position_aux<std::false_type,F,IMPL,CD>{
+    static constexpr int next = selected_implementation_position<F,IMPL,CD>::value;
+    using type = int_constant<(next < 0 ? -1 : next+1)>;
+    static constexpr int value = type::value;
+};
+
+template<typename F, typename S, typename IMPL, typename CD>
+struct selected_implementation_position<F,cons<S,IMPL>,CD> : selected_implementation_position_aux<typename selects_implementation<F,tlist_to_collection_t<S>,CD>::type,
+                                                                                                   F,IMPL,CD>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the keys array. The cells with unknown_type have the key -2.
+*    - F : The struct containing all the implementations.
+*    - IMPL : The IMPL type.
+*    - DSCOMB : The DSCOMB type.
+*/
+template<typename F, typename IMPL, typename DSCOMB>
+struct create_implementation_keys_aux{};
+
+template<typename IsUnknown, typename F, typename IMPL, typename DS>
+struct implementation_key : selected_implementation_position<F,IMPL,tlist_to_collection_t<DS>>{};
+
+template<typename F, typename IMPL, typename DS>
+struct implementation_key<std::true_type,F,IMPL,DS> : int_constant<-2>{};
+
+template<typename F, typename IMPL, typename... DS>
+struct create_implementation_keys_aux<F,IMPL,collection<DS...>>{
+    static constexpr int value[] = {implementation_key<typename has_unknown_type<DS>::type,F,IMPL,DS>::value...};
+};
+
+template<typename F, typename IMPL, typename DSCOMB>
+struct create_implementation_keys : create_implementation_keys_aux<F,IMPL,tlist_to_collection_t<DSCOMB>>{};
+
+template<typename F, typename IMPL, typename DSCOMB>
+static constexpr auto create_implementation_keys_v = create_implementation_keys<F,IMPL,DSCOMB>::value;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a parameter whose type is the i-th type of a list from TID accepts an argument whose
+*   type is the j-th one, i.e. the j-th type is the i-th one or derives from it. The first type of each list
+*   (the base type, or the enum itself) accepts every type of the list, so it is not checked here.
+*    - P : A list with the i-th and the j-th types.
+*/
+template<typename P>
+struct accepts_type{};
+
+template<typename T, typename U>
+struct accepts_type<cons<T,cons<U,nil>>> : std::bool_constant<std::is_same<T,U>::value || std::is_base_of<T,U>::value>{};
+
+template<typename R>
+struct type_pairs : cartesian_product<R,R>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Describes the lists from TID by means of arrays, so the keys can be computed with a constexpr function:
+*    - lengths : The length of each list.
+*    - unknown : The position of unknown_type in each list, or -1.
+*    - accepts : For each list, a matrix telling whether the i-th type accepts the j-th one (see accepts_type).
+*    - TID : The TID type.
+*/
+template<typename TID, typename PS>
+struct type_id_arrays_aux{};
+
+template<typename... R, typename... PS>
+struct type_id_arrays_aux<collection<R...>,collection<PS...>>{
+    static constexpr int dimensions    = sizeof...(R);
+    static constexpr int lengths[]     = {length_v<R>...,0};
+    static constexpr int unknown[]     = {position_v<unknown_type,R>...,0};
+    static constexpr bool accepts[]    = {accepts_type<PS>::value...,false};
+};
+
+template<typename TID>
+struct type_id_arrays : type_id_arrays_aux<tlist_to_collection_t<TID>,tlist_to_collection_t<apply_t<append,mapcar_t<type_pairs,TID>>>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Computes the keys array from the implementations in IMPL instead of doing the overload resolution
+*   for every cell. Each implementation is placed in the cells it accepts, and a cell takes the
+*   implementation that is at least as specific as the rest of the implementations placed in it, just like
+*   the overload resolution would do. If there is none, the key is -1, so the overload resolution is
+*   done for that cell. The overloads that are not in IMPL are not seen here, so the keys are checked
+*   afterwards (see scattered_key_selected). The cells with unknown_type have the key -2. The next implementation of each
+*   implementation is found in the same way, leaving it out (see call_next).
+*    - exact : For each cell, whether its signature belongs to IMPL.
+*    - A : The type_id_arrays of the TID type.
+*/
+template<int Cells, typename A>
+struct implementation_scatter{
+
+    // The distance between the cells whose positions in the list of the dimension d differ by one, and the
+    // position of the matrix of that dimension in A::accepts.
+    static constexpr std::array<int,A::dimensions+1> make_strides(){
+        std::array<int,A::dimensions+1> strides{};
+        strides[A::dimensions] = 1;
+        for (int d = A::dimensions-1; d >= 0; --d)
+            strides[d] = strides[d+1]*A::lengths[d];
+        return strides;
+    }
+
+    static constexpr std::array<int,A::dimensions+1> make_offsets(){
+        std::array<int,A::dimensions+1> offsets{};
+        for (int d = 0; d < A::dimensions; ++d)
+            offsets[d+1] = offsets[d] + A::lengths[d]*A::lengths[d];
+        return offsets;
+    }
+
+    static constexpr std::array<int,A::dimensions+1> strides = make_strides();
+    static constexpr std::array<int,A::dimensions+1> offsets = make_offsets();
+
+    // Returns the position in the list of the dimension d of the cell c.
+    static constexpr int coordinate(int c, int d){
+        return c/strides[d+1] % A::lengths[d];
+    }
+
+    // Checks whether the types of the cell a are accepted by the parameters of the implementation in the cell b.
+    static constexpr bool accepts(int b, int a){
+        for (int d = 0; d < A::dimensions; ++d){
+            int i = coordinate(b,d);
+            if (i != 0 && !A::accepts[offsets[d] + i*A::lengths[d] + coordinate(a,d)])
+                return false;
+        }
+        return true;
+    }
+
+    // Stores the cells accepted by the implementation in the cell b, and returns how many there are. They are
+    // enumerated from the types each parameter accepts, so the rest of cells are not visited.
+    static constexpr int accepted_cells(int b, std::array<int,Cells>& cells){
+        int accepted[offsets[A::dimensions]] = {};
+        int begin[A::dimensions+1] = {};
+        for (int d = 0; d < A::dimensions; ++d){
+            int i = coordinate(b,d);
+            begin[d+1] = begin[d];
+            for (int j = 0; j < A::lengths[d]; ++j)
+                if (i == 0 || A::accepts[offsets[d] + i*A::lengths[d] + j])
+                    accepted[begin[d+1]++] = j;
+        }
+        int position[A::dimensions+1] = {};
+        int count = 0;
+        for (int d = 0; d >= 0; ){
+            int c = 0;
+            for (int e = 0; e < A::dimensions; ++e)
+                c += accepted[begin[e]+position[e]]*strides[e+1];
+            cells[count++] = c;
+            for (d = A::dimensions-1; d >= 0 && ++position[d] == begin[d+1]-begin[d]; --d)
+                position[d] = 0;
+        }
+        return count;
+    }
+
+    static constexpr bool is_unknown(int c){
+        for (int d = 0; d < A::dimensions; ++d)
+            if (coordinate(c,d) == A::unknown[d])
+                return true;
+        return false;
+    }
+
+    // Stores the cells of the implementations, in the order of IMPL, and returns how many there are.
+    static constexpr int list_implementations(const bool* exact, std::array<int,Cells>& implementations){
+        int count = 0;
+        for (int c = 0; c < Cells; ++c)
+            if (exact[c])
+                implementations[count++] = c;
+        return count;
+    }
+
+    // Returns the position in IMPL of the most specific implementation accepting the cell c, leaving out the
+    // implementation in the position skip, or -1 if there is none or it is ambiguous.
+    static constexpr int most_specific(const std::array<int,Cells>& implementations, int count, int c, int skip){
+        int best = -1;
+        for (int k = 0; k < count; ++k)
+            if (k != skip && accepts(implementations[k],c) && (best < 0 || accepts(implementations[best],implementations[k])))
+                best = k;
+        for (int k = 0; k < count && best >= 0; ++k)
+            if (k != skip && k != best && accepts(implementations[k],c) && !accepts(implementations[k],implementations[best]))
+                best = -1;
+        return best;
+    }
+
+    // Like most_specific for every cell, but each implementation only visits the cells it accepts. The implementations
+    // are compared once per pair instead of once per cell (see specific).
+    static constexpr std::array<int,Cells> make(const bool* exact){
+        std::array<int,Cells> implementations{};
+        int count = list_implementations(exact,implementations);
+
+        std::array<int,Cells> keys{};
+        std::array<bool,Cells> ambiguous{};
+        std::array<int,Cells> cells{};
+        std::array<bool,Cells> specific{};
+        for (int c = 0; c < Cells; ++c)
+            keys[c] = -1;
+        for (int k = 0; k < count; ++k){
+            for (int j = 0; j < k; ++j)
+                specific[j] = accepts(implementations[j],implementations[k]);
+            int accepted = accepted_cells(implementations[k],cells);
+            for (int i = 0; i < accepted; ++i){
+                int c = cells[i];
+                if (keys[c] < 0 || specific[keys[c]])
+                    keys[c] = k;
+            }
+        }
+        for (int k = 0; k < count; ++k){
+            for (int j = 0; j < count; ++j)
+                specific[j] = accepts(implementations[k],implementations[j]);
+            int accepted = accepted_cells(implementations[k],cells);
+            for (int i = 0; i < accepted; ++i){
+                int c = cells[i];
+                if (k != keys[c] && !specific[keys[c]])
+                    ambiguous[c] = true;
+            }
+        }
+        bool unknown = false;
+        for (int d = 0; d < A::dimensions; ++d)
+            unknown = unknown || A::unknown[d] >= 0;
+        for (int c = 0; c < Cells; ++c)
+            keys[c] = unknown && is_unknown(c) ? -2 : ambiguous[c] ? -1 : keys[c];
+        return keys;
+    }
+
+    // For the cell of each implementation, the position in IMPL of the next implementation, i.e. the most specific
+    // of the rest of implementations accepting the cell. The rest of cells have -1.
+    static constexpr std::array<int,Cells> make_next(const bool* exact){
+        std::array<int,Cells> implementations{};
+        int count = list_implementations(exact,implementations);
+
+        std::array<int,Cells> next{};
+        for (int c = 0; c < Cells; ++c)
+            next[c] = -1;
+        for (int k = 0; k < count; ++k)
+            next[implementations[k]] = most_specific(implementations,count,implementations[k],k);
+        return next;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether the implementation placed in a cell by implementation_scatter is the one the overload
+*   resolution selects. It may not be if F has overloads that are not in IMPL, like an implementation for
+*   an intermediate type not passed to WithDerivedTypes, or one whose parameters differ in the cv qualifiers.
+*   The keys -1 and -2 are not checked.
+*    - IsPlaced : A bool_constant indicating whether the key is a position in IMPL.
+*    - F : The struct containing all the implementations.
+*    - IMPL : The IMPL type.
+*    - DS : The signature of the cell.
+*    - K : The key of the cell.
+*/
+template<typename IsPlaced, typename F, typename IMPL, typename DS, int K>
+struct scattered_key_selected : std::true_type{};
+
+template<typename F, typename IMPL, typename DS, int K>
+struct scattered_key_selected<std::true_type,F,IMPL,DS,K> : selects_implementation<F,tlist_to_collection_t<nth_t<IMPL,int_constant<K>>>,
+                                                                                   tlist_to_collection_t<DS>>{};
+
+/**
+*   Returns the keys of implementation_scatter, where the cells whose implementation is not the one
+*   selected by the overload resolution have the key -1.
+*    - keys : The keys of implementation_scatter.
+*    - selected : For each cell, whether its implementation is the one selected by the overload resolution, or
+*                 nullptr if the keys are not checked.
+*/
+template<int Cells>
+constexpr std::array<int,Cells> checked_scattered_keys(const std::array<int,Cells>& keys, const bool* selected){
+    std::array<int,Cells> checked{};
+    for (int c = 0; c < Cells; ++c)
+        checked[c] = selected == nullptr || selected[c] ? keys[c] : -1;
+    return checked;
+}
+
+/**
+*   Returns for each cell whether the overload resolution selects the implementation that implementation_scatter
+*   placed in it (see scattered_key_selected), as the selected argument of checked_scattered_keys. If F has no
+*   overloads that are not in IMPL, the keys are not checked and the value is nullptr.
+*    - IsChecked : A bool_constant indicating whether F may have overloads that are not in IMPL.
+*    - F : The struct containing all the implementations.
+*    - IMPL : The IMPL type.
+*    - SK : The type holding the keys array of implementation_scatter.
+*    - DSC : The DSCOMB type as a collection.
+*    - IS : An index_sequence with a position per cell.
+*/
+template<typename IsChecked, typename F, typename IMPL, typename SK, typename DSC, typename IS>
+struct scattered_keys_selected{
+    static constexpr const bool* value = nullptr;
+};
+
+template<typename F, typename IMPL, typename SK, typename... DS, std::size_t... IS>
+struct scattered_keys_selected<std::true_type,F,IMPL,SK,collection<DS...>,std::index_sequence<IS...>>{
+    static constexpr bool value[] = {scattered_key_selected<std::bool_constant<(SK::value[IS] >= 0)>,F,IMPL,DS,SK::value[IS]>::value...};
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   An argument that converts to every type X that some type of CL converts to. If Foreign is true, it does
+*   not convert to the types of CL themselves. Replacing an argument of the cells by it, the overload resolution
+*   finds the overloads of F receiving a type that is not the one of any cell in that position, i.e. the
+*   overloads that are not in IMPL (see foreign_overloads). A value could be bound to the references of CL,
+*   so the values whose references are in CL are excluded too.
+*    - CL : A collection with the types of a parameter in the cells of the omm table.
+*    - Foreign : A bool_constant indicating whether the types of CL are excluded.
+*/
+template<typename CL, typename Foreign>
+struct overload_probe_argument{};
+
+template<typename... CS, typename Foreign>
+struct overload_probe_argument<collection<CS...>,Foreign>{
+
+    template<typename X>
+    static constexpr bool excluded = Foreign::value && std::disjunction<std::is_same<CS,X>...>::value;
+
+    template<typename X>
+    static constexpr bool converts = std::disjunction<std::is_convertible<CS,X>...>::value && !excluded<X>;
+
+    template<typename T, typename = std::enable_if_t<converts<T&>>>
+    operator T&() const;
+
+    template<typename T, typename = std::enable_if_t<converts<T&&>>>
+    operator T&&() const;
+
+    template<typename T, typename = std::enable_if_t<converts<T> && !excluded<const T&> && !excluded<T&&> && !excluded<const T&&>>>
+    operator T() const;
+};
+
+template<typename F>
+struct overload_probe : F{
+    using F::implementation;
+    static no_implementation_tag implementation(...);
+};
+
+/**
+*   Returns a collection per parameter of a signature with the types it has in the cells of the omm table.
+*    - VBS : The VBS type without the return type.
+*    - TID : The TID type.
+*/
+template<typename T, typename C>
+struct derived_arguments{};
+
+template<typename T, typename... DS>
+struct derived_arguments<T,collection<DS...>>{
+    using type = collection<derived_argument_t<T,DS>...>;
+};
+
+template<typename VBS, typename TID>
+struct parameter_cell_types : nil{};
+
+template<typename B, typename BS, typename TID>
+struct parameter_cell_types<cons<B,BS>,TID> : cons<collection<B>,typename parameter_cell_types<BS,TID>::type>{};
+
+template<typename B, typename BS, typename TID>
+struct parameter_cell_types<cons<virtual_type<B>,BS>,TID> : cons<typename derived_arguments<B,tlist_to_collection_t<car_t<TID>>>::type,
+                                                                 typename parameter_cell_types<BS,cdr_t<TID>>::type>{};
+
+template<typename VBS, typename TID>
+using parameter_cell_types_t = typename parameter_cell_types<VBS,TID>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether F may have overloads that are not in IMPL, with one overload resolution per parameter: the
+*   argument of that parameter only converts to the types that are not the ones of any cell, and the rest convert
+*   to every type the cells accept (see overload_probe_argument). The overloads of IMPL receive the types of the
+*   cells, so the ellipsis of the probe is called if and only if no other overload exists. If F can not be
+*   derived from, it is assumed that it may have them. The overloads that only differ from a signature of a cell in
+*   the return type or in parameters with default arguments are not found.
+*    - IsDerivable : A bool_constant indicating whether F can be derived from.
+*    - F : The struct containing all the implementations.
+*    - PC : A collection with the types of each parameter in the cells (see parameter_cell_types).
+*    - IS : An index_sequence with a position per parameter.
+*/
+template<typename IsDerivable, typename F, typename PC, typename IS>
+struct foreign_overloads : std::true_type{};
+
+template<typename F, typename... PC, std::size_t... IS>
+struct foreign_overloads<std::true_type,F,collection<PC...>,std::index_sequence<IS...>>{
+
+    template<std::size_t E>
+    using result = typename next_probe_result<overload_probe<F>,collection<overload_probe_argument<PC,std::bool_constant<IS == E>>...>>::type;
+
+    static constexpr bool value = !(std::is_same<result<IS>,no_implementation_tag>::value && ...);
+};
+
+template<typename F, typename VBS, typename TID>
+struct has_foreign_overloads : foreign_overloads<std::bool_constant<std::is_class<F>::value && !std::is_final<F>::value>,F,
+                                                 tlist_to_collection_t<parameter_cell_types_t<cdr_t<VBS>,TID>>,
+                                                 std::make_index_sequence<length_v<cdr_t<VBS>>>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Deduces the rest of parameters of the overloads of G whose signature starts with the return type R and the
+*   parameters P. The deduction from an overload set only succeeds if exactly one overload deduces them, so deduce
+*   returns a collection with the rest of parameters of that overload. If several overloads deduce them, the rest
+*   of parameters are not deduced, i.e. they are an empty pack.
+*    - G : The struct containing the overloads, F or a prefix_probe.
+*    - CS : A collection with the return type and the first parameters.
+*/
+template<typename R, typename... P>
+struct prefix_deduction{
+    template<typename... Rest>
+    static collection<Rest...> deduce(R(*)(P...,Rest...));
+};
+
+template<typename G, typename CS, typename = void>
+struct deduced_overload{
+    using type = void;
+};
+
+template<typename G, typename R, typename... P>
+struct deduced_overload<G,collection<R,P...>,std::void_t<decltype(prefix_deduction<R,P...>::deduce(&G::implementation))>>{
+    using type = decltype(prefix_deduction<R,P...>::deduce(&G::implementation));
+};
+
+/**
+*   Adds to F an overload whose signature starts like CS and ends with prefix_probe_tag. Deducing the rest of
+*   parameters from the probe, the tag is deduced if and only if F has no overload whose signature starts like CS.
+*    - F : The struct containing all the implementations.
+*    - CS : A collection with the return type and the first parameters.
+*/
+struct prefix_probe_tag{};
+
+template<typename F, typename CS>
+struct prefix_probe{};
+
+template<typename F, typename R, typename... P>
+struct prefix_probe<F,collection<R,P...>> : F{
+    using F::implementation;
+    static R implementation(P...,prefix_probe_tag);
+};
+
+template<typename F, typename CS>
+struct has_prefix_overloads : std::bool_constant<!std::is_same<typename deduced_overload<prefix_probe<F,CS>,CS>::type,
+                                                               collection<prefix_probe_tag>>::value>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   An implementation of F whose signature is the one of a cell of the omm table.
+*    - Cell : The cell.
+*    - S : The signature, as in DSCOMB.
+*/
+template<int Cell, typename S>
+struct found_implementation{
+    static constexpr int cell = Cell;
+    using signature = S;
+};
+
+template<typename FI>
+struct found_signature{
+    using type = typename FI::signature;
+};
+
+/**
+*   Returns the cell whose signature ends with the parameters AC, or -1 if some parameter is not the type of a cell.
+*    - Cell : The cell of the first parameters, counted as if they were the whole signature.
+*    - AC : A collection with the rest of parameters.
+*    - PC : A collection with the types of the rest of parameters in the cells (see parameter_cell_types).
+*/
+template<int Cell, typename AC, typename PC>
+struct signature_cell : int_constant<Cell>{};
+
+template<int Cell, typename A, typename... AS, typename... CS, typename... PC>
+struct signature_cell<Cell,collection<A,AS...>,collection<collection<CS...>,PC...>>
+    : signature_cell<(Cell < 0 || position_v<A,tlist_t<CS...>> < 0 ? -1 : Cell*int(sizeof...(CS)) + position_v<A,tlist_t<CS...>>),
+                     collection<AS...>,collection<PC...>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates a list with the implementations of F whose signature is the one of a cell (see found_implementation),
+*   in the order of the cells. Instead of looking for an implementation in every cell, the signatures are visited as
+*   a tree whose levels are the parameters, and before choosing the type of a parameter, two deductions from the
+*   overloads of F tell how many overloads start like the parameters already chosen (see prefix_deduction):
+*    - None : The cells below are not visited.
+*    - One : The deduction returns its signature, so it is known without visiting the cells below.
+*    - More : Each type of the parameter is visited.
+*   The parameters with only one type are chosen without deductions, and the last one is checked for each cell of
+*   the branch with has_exact_implementation. So the number of deductions grows with the number of implementations
+*   and not with the number of cells. If F has function templates named implementation, nothing is deduced from
+*   them, so every cell is visited.
+*    - F : The struct containing all the implementations.
+*    - Cell : The cell of the parameters already chosen, counted as if they were the whole signature.
+*    - CS : A collection with the return type and the parameters already chosen.
+*    - PC : A collection with the types of the rest of parameters in the cells (see parameter_cell_types).
+*/
+template<typename F, int Cell, typename CS, typename PC>
+struct implementation_search{};
+
+template<int Cell, typename S>
+struct implementation_search_found : cons<found_implementation<Cell,S>,nil>{};
+
+template<typename S>
+struct implementation_search_found<-1,S> : nil{};
+
+template<typename F, int Cell, typename CS, typename PC, typename IS = void>
+struct implementation_search_branch{};
+
+template<typename F, int Cell, typename CS, typename... C, typename... PC>
+struct implementation_search_branch<F,Cell,CS,collection<collection<C...>,PC...>,void>
+    : implementation_search_branch<F,Cell,CS,collection<collection<C...>,PC...>,std::index_sequence_for<C...>>{};
+
+template<typename F, int Cell, typename... S, typename... C, typename... PC, std::size_t... IS>
+struct implementation_search_branch<F,Cell,collection<S...>,collection<collection<C...>,PC...>,std::index_sequence<IS...>>
+    : append<typename implementation_search<F,Cell*int(sizeof...(C))+int(IS),collection<S...,C>,collection<PC...>>::type...>{};
+
+template<typename Rest, typename F, int Cell, typename CS, typename PC>
+struct implementation_search_deduced : implementation_search_branch<F,Cell,CS,PC>{};
+
+template<typename... Rest, typename F, int Cell, typename... S, typename... PC>
+struct implementation_search_deduced<collection<Rest...>,F,Cell,collection<S...>,collection<PC...>>
+    : std::conditional_t<sizeof...(Rest) == sizeof...(PC),
+                         implementation_search_found<signature_cell<Cell,collection<Rest...>,collection<PC...>>::value,tlist_t<S...,Rest...>>,
+                         implementation_search_branch<F,Cell,collection<S...>,collection<PC...>>>{};
+
+template<typename HasOverloads, typename F, int Cell, typename CS, typename PC>
+struct implementation_search_prefix : nil{};
+
+template<typename F, int Cell, typename CS, typename PC>
+struct implementation_search_prefix<std::true_type,F,Cell,CS,PC> : implementation_search_deduced<typename deduced_overload<F,CS>::type,F,Cell,CS,PC>{};
+
+template<typename F, int Cell, typename... S>
+struct implementation_search<F,Cell,collection<S...>,collection<>>
+    : std::conditional_t<has_exact_implementation<F,collection<S...>>::value,implementation_search_found<Cell,tlist_t<S...>>,nil>{};
+
+template<typename F, int Cell, typename... S, typename C, typename... PC>
+struct implementation_search<F,Cell,collection<S...>,collection<collection<C>,PC...>>
+    : implementation_search<F,Cell,collection<S...,C>,collection<PC...>>{};
+
+template<typename F, int Cell, typename... S, typename C0, typename C1, typename... CS, typename... PC>
+struct implementation_search<F,Cell,collection<S...>,collection<collection<C0,C1,CS...>,PC...>>
+    : implementation_search_prefix<typename has_prefix_overloads<F,collection<S...>>::type,F,Cell,collection<S...>,
+                                   collection<collection<C0,C1,CS...>,PC...>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the list of implementations found by implementation_search, and from it the IMPL list and a
+*   bool per cell telling whether its signature belongs to IMPL. If F can not be derived from, nothing is found.
+*    - F : The struct containing all the implementations.
+*    - VBS : The VBS type.
+*    - TID : The TID type.
+*/
+template<typename IsDerivable, typename F, typename VBS, typename TID>
+struct found_implementations_aux : nil{};
+
+template<typename F, typename VBS, typename TID>
+struct found_implementations_aux<std::true_type,F,VBS,TID>
+    : implementation_search<F,0,collection<car_t<VBS>>,tlist_to_collection_t<parameter_cell_types_t<cdr_t<VBS>,TID>>>{};
+
+template<typename F, typename VBS, typename TID>
+struct found_implementations : found_implementations_aux<std::bool_constant<std::is_class<F>::value && !std::is_final<F>::value>,F,VBS,TID>{};
+
+template<typename F, typename VBS, typename TID>
+using exact_implementations_t = mapcar_t<found_signature,typename found_implementations<F,VBS,TID>::type>;
+
+template<int Cells, typename FC>
+struct exact_cells{};
+
+template<int Cells, typename... FI>
+struct exact_cells<Cells,collection<FI...>>{
+    static constexpr std::array<bool,Cells> make(){
+        constexpr int cells[] = {FI::cell...,-1};
+        std::array<bool,Cells> exact{};
+        for (int k = 0; k < int(sizeof...(FI)); ++k)
+            exact[cells[k]] = true;
+        return exact;
+    }
+    static constexpr std::array<bool,Cells> value = make();
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the keys array with implementation_scatter. If F may have overloads that are not in IMPL (see
+*   foreign_overloads), each key is checked with one overload resolution, so they are taken into account.
+*    - F : The struct containing all the implementations.
+*    - VBS : The VBS type.
+*    - TID : The TID type.
+*    - Cells : The number of cells.
+*    - DSCOMB : The DSCOMB type.
+*/
+template<typename F, typename VBS, typename TID, int Cells>
+struct scattered_keys{
+    static constexpr std::array<bool,Cells> exact = exact_cells<Cells,tlist_to_collection_t<typename found_implementations<F,VBS,TID>::type>>::value;
+    static constexpr std::array<int,Cells> value = implementation_scatter<Cells,type_id_arrays<TID>>::make(exact.data());
+};
+
+template<typename F, typename VBS, typename TID, typename DSCOMB, typename IMPL>
+struct scatter_implementation_keys_aux{};
+
+template<typename F, typename VBS, typename TID, typename... DS, typename IMPL>
+struct scatter_implementation_keys_aux<F,VBS,TID,collection<DS...>,IMPL>{
+    using SK = scattered_keys<F,VBS,TID,sizeof...(DS)>;
+    static constexpr auto exact = SK::exact;
+    static constexpr bool checked = has_foreign_overloads<F,VBS,TID>::value;
+    static constexpr auto selected = scattered_keys_selected<std::bool_constant<checked>,F,IMPL,SK,collection<DS...>,std::index_sequence_for<DS...>>::value;
+    static constexpr std::array<int,sizeof...(DS)> value = checked_scattered_keys<sizeof...(DS)>(SK::value,selected);
+    static constexpr std::array<int,sizeof...(DS)> next  = implementation_scatter<sizeof...(DS),type_id_arrays<TID>>::make_next(exact.data());
+};
+
+template<typename F, typename VBS, typename TID, typename DSCOMB>
+struct scatter_implementation_keys : scatter_implementation_keys_aux<F,VBS,TID,tlist_to_collection_t<DSCOMB>,exact_implementations_t<F,VBS,TID>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the function pointer stored in the cells that call the implementation whose signature
+*   is S. If S is the BS, the implementation itself is stored, so no intermediate function is needed
+*   (the pointer is noexcept if the implementation is). In other case, all these cells share the same function.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - S : The signature of the implementation.
+*/
+template<typename IsDirect, typename F, typename BS, typename S>
+struct implementation_cell_aux : make_function_cell<F,BS,S>{};
+
+template<typename F, typename BS, typename S>
+struct implementation_cell_aux<std::true_type,F,BS,S>{
+    using function_type = std::conditional_t<has_nothrow_implementation<F,tlist_to_collection_t<BS>>::value,
+                                             add_noexcept_t<signature_to_function_type_t<BS>>,
+                                             signature_to_function_type_t<BS>>;
+    static constexpr std::add_pointer_t<function_type> value = &F::implementation;
+};
+
+#ifdef OMM_LATENCY_HISTOGRAMS
+// Every implementation is called through make_function_cell, which times it.
+template<typename F, typename BS, typename S>
+struct implementation_cell : implementation_cell_aux<std::false_type,F,BS,S>{};
+#else
+template<typename F, typename BS, typename S>
+struct implementation_cell : implementation_cell_aux<typename std::is_same<BS,S>::type,F,BS,S>{};
+#endif
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the function pointer stored in a cell of the omm table. If the implementation called
+*   by the cell is in IMPL, the function is shared with the rest of cells calling it. In other case,
+*   the overload resolution is done for this cell.
+*    - Key : The key of the cell.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DS : The signature of the cell.
+*    - IMPL : The IMPL type.
+*/
+template<typename Key, typename F, typename BS, typename DS, typename IMPL>
+struct shared_function_cell : implementation_cell<F,BS,nth_t<IMPL,Key>>{};
+
+template<typename F, typename BS, typename DS, typename IMPL>
+struct shared_function_cell<int_constant<-1>,F,BS,DS,IMPL> : make_function_cell<F,BS,DS>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the function pointer stored in a cell of the omm table, taking into account the policy.
+*   If the policy checks the calls, the cells with unknown_type (key -2) and the cells without implementation
+*   call the policy instead.
+*    - Key : The key of the cell.
+*    - P : The policy.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DS : The signature of the cell.
+*    - IMPL : The IMPL type.
+*/
+template<typename IsMissing, typename P, typename BS, typename DS, typename C>
+struct missing_implementation_cell : C{};
+
+template<typename P, typename BS, typename DS, typename C>
+struct missing_implementation_cell<std::true_type,P,BS,DS,C> : error_cell<P,dispatch_error_kind::missing_implementation,BS,DS>{};
+
+template<typename Key, typename P, typename F, typename BS, typename DS, typename IMPL>
+struct policy_function_cell{
+    using cell = shared_function_cell<Key,F,BS,DS,IMPL>;
+    using is_missing = std::bool_constant<P::checked::value && std::is_null_pointer<std::remove_const_t<decltype(cell::value)>>::value>;
+    static constexpr auto value = missing_implementation_cell<is_missing,P,BS,DS,cell>::value;
+};
+
+template<typename P, typename F, typename BS, typename DS, typename IMPL>
+struct policy_function_cell<int_constant<-2>,P,F,BS,DS,IMPL> : error_cell<P,dispatch_error_kind::unknown_type,BS,BS>{};
+
+/**
+*   The policy_function_cell of a cell from its key. Only the cells with the key -1 depend on their signature, so
+*   the rest of cells with the same key share the instantiation instead of having one per cell.
+*    - Key : The key of the cell.
+*    - P : The policy.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - IMPL : The IMPL type.
+*    - DS : The signature of the cell.
+*/
+template<int Key, typename P, typename F, typename BS, typename IMPL>
+struct keyed_function_cell{
+    template<typename DS>
+    using type = policy_function_cell<int_constant<Key>,P,F,BS,void,IMPL>;
+};
+
+template<typename P, typename F, typename BS, typename IMPL>
+struct keyed_function_cell<-1,P,F,BS,IMPL>{
+    template<typename DS>
+    using type = policy_function_cell<int_constant<-1>,P,F,BS,DS,IMPL>;
+};
+
+template<int Key, typename P, typename F, typename BS, typename DS, typename IMPL>
+using keyed_function_cell_t = typename keyed_function_cell<Key,P,F,BS,IMPL>::template type<DS>;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the omm table. If no cell can throw, the function pointers are noexcept.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DSCOMB : The DSCOMB type.
+*    - IMPL : The IMPL type.
+*    - P : The policy.
+*    - K : A struct whose member value is the keys array.
+*/
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K, typename IS>
+struct create_omm_table_aux{};
+
+template<typename F, typename BS, typename... DS, typename IMPL, typename P, typename K, std::size_t... IS>
+struct create_omm_table_aux<F,BS,collection<DS...>,IMPL,P,K,std::index_sequence<IS...>>{
+    static constexpr bool nothrow = (is_nothrow_cell_v<decltype(keyed_function_cell_t<K::value[IS],P,F,BS,DS,IMPL>::value)> && ...);
+    using function_type = std::conditional_t<nothrow,add_noexcept_t<signature_to_function_type_t<BS>>,signature_to_function_type_t<BS>>;
+    static constexpr std::add_pointer_t<function_type> value[] = {keyed_function_cell_t<K::value[IS],P,F,BS,DS,IMPL>::value...};
+};
+
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K>
+struct create_omm_table : create_omm_table_aux<F,BS,tlist_to_collection_t<DSCOMB>,IMPL,P,K,std::make_index_sequence<length_v<DSCOMB>>>{};
+
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K>
+static constexpr bool create_omm_table_nothrow_v = create_omm_table<F,BS,DSCOMB,IMPL,P,K>::nothrow;
+
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K>
+static constexpr auto create_omm_table_v = create_omm_table<F,BS,DSCOMB,IMPL,P,K>::value;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the number of different functions the omm table points to, without counting the
+*   implementations stored directly. The cells with the same key share the function, the cells for
+*   unknown types (key -2) share the function of the policy and the rest of cells have their own function.
+*    - keys : The keys array.
+*    - table : The omm table.
+*    - direct : The key of the implementation stored directly, or -1.
+*/
+template<int Cells, typename P>
+constexpr int count_thunks(const int* keys, const P* table, int direct){
+    std::array<bool,Cells+2> seen{};
+    int count = 0;
+    for (int i = 0; i < Cells; ++i){
+        if (table[i] == nullptr || (direct >= 0 && keys[i] == direct))
+            continue;
+        if (keys[i] == -1)
+            ++count;
+        else if (!seen[keys[i]+2]){
+            seen[keys[i]+2] = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+//---------------------------------------------------------------------------------
+//-------------------------------- Table encodings --------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   The ways the omm table is stored in the program:
+*    - pointer_encoding : An array with a function pointer per cell.
+*    - index_encoding : An array with the different function pointers and an array with the position of the
+*                       function of each cell in the first one. The positions are the smallest unsigned integers
+*                       that fit, so only the small array needs relocations when the program is loaded.
+*    - lazy_encoding : Only the functions of the implementations and a resolver are stored. Each cell is resolved
+*                      the first time it is called and cached in a zero-initialized array, so the program only
+*                      pays for the cells it calls. Only for table_omm.
+*/
+struct pointer_encoding{
+    static constexpr const char* name = "pointers";
+};
+
+struct index_encoding{
+    static constexpr const char* name = "indices";
+};
+
+struct lazy_encoding{
+    static constexpr const char* name = "lazy";
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the number of different function pointers in the omm table, counting nullptr and the
+*   implementation stored directly (see count_thunks).
+*    - keys : The keys array.
+*    - table : The omm table.
+*/
+template<int Cells, typename P>
+constexpr int count_functions(const int* keys, const P* table){
+    std::array<bool,Cells+2> seen{};
+    bool null = false;
+    int count = 0;
+    for (int i = 0; i < Cells; ++i){
+        if (table[i] == nullptr){
+            count += null ? 0 : 1;
+            null = true;
+        }
+        else if (keys[i] == -1)
+            ++count;
+        else if (!seen[keys[i]+2]){
+            seen[keys[i]+2] = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+*   Returns the smallest unsigned integer type that can store the position of any of N functions.
+*/
+template<int N>
+using function_index_t = std::conditional_t<(N <= 256),std::uint8_t,std::conditional_t<(N <= 65536),std::uint16_t,std::uint32_t>>;
+
+/**
+*   The omm table stored with index_encoding, and the function that creates it from the omm table.
+*    - I : The type of the positions.
+*    - Functions : The number of different function pointers.
+*    - Cells : The number of cells.
+*    - P : The type of the function pointers.
+*/
+template<typename I, int Functions, int Cells, typename P>
+struct indexed_table{
+    std::array<P,Functions> functions;
+    std::array<I,Cells> indices;
+};
+
+template<typename I, int Functions, int Cells, typename P>
+constexpr indexed_table<I,Functions,Cells,P> make_indexed_table(const int* keys, const P* table){
+    indexed_table<I,Functions,Cells,P> result{};
+    std::array<int,Cells+3> position{};
+    int count = 0;
+    for (int i = 0; i < Cells; ++i){
+        // The positions are stored plus one: the first one for nullptr and the rest for the keys.
+        bool null = table[i] == nullptr;
+        int& p = null ? position[0] : position[keys[i]+3];
+        if (p == 0 || (!null && keys[i] == -1)){
+            p = ++count;
+            result.functions[count-1] = table[i];
+        }
+        result.indices[i] = static_cast<I>(p-1);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Stores the omm table with an encoding and returns the function pointer of a cell.
+*    - E : The encoding.
+*    - T : The type holding the omm table (see create_omm_table).
+*    - K : The type holding the keys array.
+*    - Cells : The number of cells.
+*    - TID : The TID type, needed by lazy_encoding.
+*    - VBS : The VBS type, needed by lazy_encoding.
+*    - index : The cell.
+*/
+template<typename E, typename T, typename K, int Cells, typename TID = void, typename VBS = void>
+struct encoded_table{
+
+    static constexpr std::size_t bytes = sizeof(T::value);
+
+    static auto at(int index) noexcept{
+        return T::value[index];
+    }
+};
+
+template<typename T, typename K, int Cells, typename TID, typename VBS>
+struct encoded_table<index_encoding,T,K,Cells,TID,VBS>{
+
+    static constexpr int count = count_functions<Cells>(&K::value[0],T::value);
+    using index_type = function_index_t<count>;
+    static constexpr auto value = make_indexed_table<index_type,count,Cells>(&K::value[0],T::value);
+    static constexpr auto functions = value.functions;
+    static constexpr auto indices = value.indices;
+
+    static constexpr std::size_t bytes = sizeof(functions) + sizeof(indices);
+
+    static auto at(int index) noexcept{
+        return functions[indices[index]];
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The overload cells of lazy_encoding, whose function can not be found by its resolver: the cells where
+*   the overload resolution is done (key -1), and the cells whose key does not come from implementation_scatter
+*   (see OMM_PER_CELL_RESOLUTION). Their positions are sorted.
+*    - K : The type holding the keys array.
+*    - SK : The type holding the keys array of implementation_scatter.
+*/
+constexpr bool is_overload_cell(const int* keys, const int* scattered, int c){
+    return keys[c] == -1 || keys[c] != scattered[c];
+}
+
+template<int Cells, typename K, typename SK>
+struct lazy_overload_cells{
+
+    static constexpr int count_cells(){
+        int count = 0;
+        for (int c = 0; c < Cells; ++c)
+            count += is_overload_cell(&K::value[0],&SK::value[0],c);
+        return count;
+    }
+
+    static constexpr int count = count_cells();
+
+    static constexpr std::array<int,count> make(){
+        std::array<int,count> cells{};
+        int n = 0;
+        for (int c = 0; c < Cells; ++c)
+            if (is_overload_cell(&K::value[0],&SK::value[0],c))
+                cells[n++] = c;
+        return cells;
+    }
+
+    static constexpr std::array<int,count> value = make();
+};
+
+/**
+*   The cells of the implementations of IMPL, in order.
+*    - SK : The type holding the keys array of implementation_scatter.
+*/
+template<int Cells, int N, typename SK>
+struct lazy_implementation_cells{
+
+    static constexpr std::array<int,N> make(){
+        std::array<int,N> cells{};
+        int n = 0;
+        for (int c = 0; c < Cells; ++c)
+            if (SK::exact[c])
+                cells[n++] = c;
+        return cells;
+    }
+
+    static constexpr std::array<int,N> value = make();
+};
+
+template<int Cells>
+constexpr bool is_called_implementation(const int* keys, int k){
+    for (int c = 0; c < Cells; ++c)
+        if (keys[c] == k)
+            return true;
+    return false;
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The arrays stored by lazy_encoding. Their types only depend on the cells and the functions, so the
+*   names of their symbols are short (unlike the ones of DSCOMB).
+*/
+template<int... CS>
+struct lazy_cell_list{
+    static constexpr int count = sizeof...(CS);
+    static constexpr int value[] = {CS...,0};
+};
+
+template<typename FP, FP... FS>
+struct lazy_function_list{
+    static constexpr FP value[] = {FS...,nullptr};
+};
+
+template<typename C, typename IS>
+struct make_lazy_cell_list{};
+
+template<typename C, std::size_t... IS>
+struct make_lazy_cell_list<C,std::index_sequence<IS...>>{
+    using type = lazy_cell_list<C::value[IS]...>;
+};
+
+template<typename C>
+using make_lazy_cell_list_t = typename make_lazy_cell_list<C,std::make_index_sequence<C::value.size()>>::type;
+
+//---------------------------------------------------------------------------------
+
+// The implementations that no cell calls (like the ones for unknown_type) are not generated.
+template<typename IsCalled, typename FP, typename P, typename F, typename BS, typename IMPL, typename Key>
+struct lazy_implementation_function{
+    static constexpr FP value = nullptr;
+};
+
+template<typename FP, typename P, typename F, typename BS, typename IMPL, typename Key>
+struct lazy_implementation_function<std::true_type,FP,P,F,BS,IMPL,Key>{
+    static constexpr FP value = policy_function_cell<Key,P,F,BS,nth_t<IMPL,Key>,IMPL>::value;
+};
+
+// The cells with unknown_type only exist if the policy checks the calls.
+template<typename Checked, typename FP, typename P, typename BS>
+struct lazy_unknown_function{
+    static constexpr FP value = nullptr;
+};
+
+template<typename FP, typename P, typename BS>
+struct lazy_unknown_function<std::true_type,FP,P,BS>{
+    static constexpr FP value = error_cell<P,dispatch_error_kind::unknown_type,BS,BS>::value;
+};
+
+/**
+*   The functions stored by lazy_encoding: one per implementation of IMPL, in order, then the function of
+*   the cells with unknown_type, and one per overload cell. Only these functions are generated.
+*    - FP : The type of the function pointers.
+*    - P : The policy.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DSCOMB : The DSCOMB type.
+*    - IMPL : The IMPL type.
+*    - K : The type holding the keys array.
+*    - C : The lazy_overload_cells.
+*/
+template<int Cells, typename FP, typename P, typename F, typename BS, typename IMPL, typename K, typename IS>
+struct lazy_implementation_functions{};
+
+template<int Cells, typename FP, typename P, typename F, typename BS, typename IMPL, typename K, std::size_t... IS>
+struct lazy_implementation_functions<Cells,FP,P,F,BS,IMPL,K,std::index_sequence<IS...>>{
+    using type = lazy_function_list<FP,lazy_implementation_function<std::bool_constant<is_called_implementation<Cells>(&K::value[0],IS)>,
+                                                                    FP,P,F,BS,IMPL,int_constant<IS>>::value...,
+                                       lazy_unknown_function<typename P::checked,FP,P,BS>::value>;
+};
+
+template<typename FP, typename P, typename F, typename BS, typename DSCOMB, typename IMPL, typename K, typename C, typename IS>
+struct lazy_overload_functions{};
+
+template<typename FP, typename P, typename F, typename BS, typename DSCOMB, typename IMPL, typename K, typename C, std::size_t... IS>
+struct lazy_overload_functions<FP,P,F,BS,DSCOMB,IMPL,K,C,std::index_sequence<IS...>>{
+    using type = lazy_function_list<FP,policy_function_cell<int_constant<K::value[C::value[IS]]>,P,F,BS,
+                                                            nth_t<DSCOMB,int_constant<C::value[IS]>>,IMPL>::value...>;
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The resolver and the cache of lazy_encoding. The first call to a cell finds its function, the same one
+*   that pointer_encoding would store: the function of an overload cell, of the cells with unknown_type, or
+*   of the most specific implementation of IMPL accepting the cell (see implementation_scatter). Then, it is
+*   stored in the cache, where the next calls find it. The functions are code, so the cache is read and
+*   written with relaxed atomics: two threads resolving the same cell store the same function. The tables
+*   with the same cells and functions share the cache.
+*    - TID : The TID type.
+*    - IC : The lazy_cell_list of the cells of the implementations of IMPL.
+*    - IF : The lazy_function_list of the implementations of IMPL and of the cells with unknown_type.
+*    - OC : The lazy_cell_list of the overload cells.
+*    - OF : The lazy_function_list of the overload cells.
+*/
+template<typename FP, typename TID, typename IC, typename IF, typename OC, typename OF>
+struct lazy_table{
+
+    static constexpr int cells = table_length_v<TID>;
+    using scatter = implementation_scatter<cells,type_id_arrays<TID>>;
+
+    static inline std::atomic<FP> cache[cells] = {};
+
+    static FP resolve(int c) noexcept{
+        const int* overload = std::lower_bound(OC::value,OC::value+OC::count,c);
+        if (overload != OC::value+OC::count && *overload == c)
+            return OF::value[overload-OC::value];
+        if (scatter::is_unknown(c))
+            return IF::value[IC::count];
+        int best = -1;
+        for (int k = 0; k < IC::count; ++k)
+            if (scatter::accepts(IC::value[k],c) && (best < 0 || scatter::accepts(IC::value[best],IC::value[k])))
+                best = k;
+        return IF::value[best];
+    }
+
+    static FP first_call(int index) noexcept{
+        FP f = resolve(index);
+        cache[index].store(f,std::memory_order_relaxed);
+        return f;
+    }
+
+    static FP at(int index) noexcept{
+        FP f = cache[index].load(std::memory_order_relaxed);
+        return f ? f : first_call(index);
+    }
+};
+
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K, int Cells, typename TID, typename VBS>
+struct encoded_table<lazy_encoding,create_omm_table<F,BS,DSCOMB,IMPL,P,K>,K,Cells,TID,VBS>{
+
+    using function_pointer = std::add_pointer_t<typename create_omm_table<F,BS,DSCOMB,IMPL,P,K>::function_type>;
+    using SK = scattered_keys<F,VBS,TID,Cells>;
+    using A = type_id_arrays<TID>;
+
+    static constexpr int implementations = length_v<IMPL>;
+    using IC = make_lazy_cell_list_t<lazy_implementation_cells<Cells,implementations,SK>>;
+    using IF = typename lazy_implementation_functions<Cells,function_pointer,P,F,BS,IMPL,K,std::make_index_sequence<implementations>>::type;
+
+    using overload_cells = lazy_overload_cells<Cells,K,SK>;
+    static constexpr int overloads = overload_cells::count;
+    using OC = make_lazy_cell_list_t<overload_cells>;
+    using OF = typename lazy_overload_functions<function_pointer,P,F,BS,DSCOMB,IMPL,K,overload_cells,std::make_index_sequence<overloads>>::type;
+
+    using table = lazy_table<function_pointer,TID,IC,IF,OC,OF>;
+
+    // The resolver and the functions. The cache is not counted: it is zero-initialized, so it is not in the program.
+    static constexpr std::size_t bytes = sizeof(IC::value) + sizeof(IF::value) + sizeof(OC::value) + sizeof(OF::value) +
+                                         sizeof(A::lengths) + sizeof(A::unknown) + sizeof(A::accepts);
+
+    static auto at(int index) noexcept{
+        return table::at(index);
+    }
+};
+
+//---------------------------------------------------------------------------------
+//--------------------------------- Type identity ---------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   When a program loads shared objects (for example, with RTLD_LOCAL), the same type can be
+*   represented by several type_info objects, and comparing them may need to compare their names.
+*   type_identity stores the addresses of the type_info objects of a type found so far (its aliases),
+*   so the names of a type_info object are compared only the first time it is seen. The aliases are
+*   written only when they are found, so the dispatch just reads them. The type_info objects that match
+*   none of the types of a list are stored too, as the aliases of unknown_in (see position_derived_runtime).
+*    - D : The type.
+*    - N : The maximum number of aliases.
+*/
+template<typename D, int N = 8>
+struct type_identity{
+
+    static constexpr int max_aliases = N;
+    static inline std::atomic<const std::type_info*> aliases[max_aliases] = {};
+
+    static bool is_alias(const std::type_info& info){
+        for (int i = 0; i < max_aliases; ++i){
+            const std::type_info* alias = aliases[i].load(std::memory_order_relaxed);
+            if (alias == &info)
+                return true;
+            if (alias == nullptr)
+                return false;
+        }
+        return false;
+    }
+
+    static void add_alias(const std::type_info& info){
+        for (int i = 0; i < max_aliases; ++i){
+            const std::type_info* expected = nullptr;
+            if (aliases[i].compare_exchange_strong(expected,&info,std::memory_order_relaxed) || expected == &info)
+                return;
+        }
+    }
+};
+
+/**
+*   Represents the types that are not in the list BM, so type_identity<unknown_in<BM>> remembers the
+*   type_info objects that match none of them.
+*    - BM : A list whose first element is a base type and the rest are derived types.
+*/
+template<typename BM>
+struct unknown_in{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Comparisons between the type_info of an object and a type D:
+*    - same_type_address : Compares the addresses of the type_info objects.
+*    - same_type_alias : Compares the address of the type_info object with the aliases of D.
+*    - same_type_name : Compares the names. If they are equal, the type_info object becomes an alias of D.
+*/
+template<typename D>
+struct same_type_address{
+    static bool call(const std::type_info& info){
+        return &info == &typeid(D);
+    }
+};
+
+template<typename D>
+struct same_type_alias{
+    static bool call(const std::type_info& info){
+        return type_identity<D>::is_alias(info);
+    }
+};
+
+template<typename D>
+struct same_type_name{
+    static bool call(const std::type_info& info){
+        if (info != typeid(D))
+            return false;
+        type_identity<D>::add_alias(info);
+        return true;
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//---------------------------------- Get index ------------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns an index from the type_info of an object. Only the types D such that Same<D>::call(info)
+*   is true are considered equal to the type of the object.
+*    - BM : A list whose first element is a base type and the rest are derived types.
+*    - Same : The comparison to use (see type_identity).
+*    - info : The type_info of an object.
+*/
+template<typename BM, template<typename> typename Same>
+struct position_derived_runtime_aux{
+    static int call(const std::type_info& info){
+        return 0;
+    }
+};
+
+template<template<typename> typename Same>
+struct position_derived_runtime_aux<cons<unknown_type,nil>,Same>{
+    static int call(const std::type_info&){
+        return 0;
+    }
+};
+
+template<typename D, typename S, template<typename> typename Same>
+struct position_derived_runtime_aux<cons<D,S>,Same>{
+    static int call(const std::type_info& info){
+        if (Same<D>::call(info))
+            return 0;
+        else
+            return 1+position_derived_runtime_aux<S,Same>::call(info);
+
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns an index from the type_info of an object. The addresses of the type_info objects are
+*   compared first, so the names are only compared if the object comes from another shared object.
+*   If the type is not found, the index is the one of unknown_type (or the length of BM if it has not
+*   unknown_type), and the type_info object is remembered as unknown, so the names of each candidate
+*   are compared at most once per type_info object (while there is room in max_unknown).
+*    - BM : A list whose first element is a base type and the rest are derived types.
+*    - info : The type_info of an object.
+*/
+template<typename BM>
+struct position_derived_runtime{
+
+    static constexpr int known = position_v<unknown_type,BM> < 0 ? length_v<BM> : position_v<unknown_type,BM>;
+    static constexpr int max_unknown = 32;
+    using unknown = type_identity<unknown_in<BM>,max_unknown>;
+
+    static int call(const std::type_info& info){
+        int k = position_derived_runtime_aux<BM,same_type_address>::call(info);
+        if (k < known)
+            return k;
+        k = position_derived_runtime_aux<BM,same_type_alias>::call(info);
+        if (k < known || unknown::is_alias(info))
+            return k;
+        k = position_derived_runtime_aux<BM,same_type_name>::call(info);
+        if (k >= known)
+            unknown::add_alias(info);
+        return k;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the type_info of the most derived type of an object. Pointers and adapters are dereferenced.
+*   Adapters are turned into raw pointers first, so a null pointer or adapter throws std::bad_typeid.
+*    - A : The type of the object the type_info will be created from.
+*    - a : The object to retrieve its type_info.
+*/
+template<typename IsPtr, typename IsAdapter, typename A>
+struct get_type_id_aux{
+    static const std::type_info& call(A&& a){
+        return typeid(a);
+    }
+};
+
+template<typename A>
+struct get_type_id_aux<std::true_type,std::false_type,A>{
+    static const std::type_info& call(A&& a){
+        return typeid(*a);
+    }
+};
+
+template<typename A>
+struct get_type_id_aux<std::false_type,std::true_type,A>{
+    static const std::type_info& call(A&& a){
+        return typeid(*virtual_adapter_of<A>::get(a));
+    }
+};
+
+template<typename A>
+struct get_type_id{
+    static const std::type_info& call(A&& a){
+        return get_type_id_aux<typename std::is_pointer<std::remove_reference_t<A>>::type,typename virtual_adapter_of<A>::type,A>::call(std::forward<A>(a));
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the position in the list of an enum_value of a value. If the value is not listed,
+*   returns 0. If the listed values are close enough, the position is read from an array indexed
+*   by the value. In other case, the value is compared with every listed value.
+*    - E : The type of the value.
+*    - VS... : The listed values.
+*    - e : The value to look for.
+*/
+template<typename IsEnum, typename E>
+struct underlying_value{
+    using type = E;
+};
+
+template<typename E>
+struct underlying_value<std::true_type,E> : std::underlying_type<E>{};
+
+template<typename IsDense, typename E, E... VS>
+struct enum_position_aux{
+    static int call(E e){
+        int k = 0;
+        int p = 0;
+        ((++k, e == VS ? (p = k, true) : false) || ...);
+        return p;
+    }
+};
+
+template<typename E, E... VS>
+struct enum_position_aux<std::true_type,E,VS...>{
+
+    using U = typename underlying_value<typename std::is_enum<E>::type,E>::type;
+    static constexpr long long min = std::min({static_cast<long long>(static_cast<U>(VS))...});
+    static constexpr long long max = std::max({static_cast<long long>(static_cast<U>(VS))...});
+
+    static constexpr std::array<int,max-min+1> make(){
+        std::array<int,max-min+1> positions{};
+        int k = 0;
+        ((positions[static_cast<long long>(static_cast<U>(VS))-min] = ++k), ...);
+        return positions;
+    }
+
+    static constexpr std::array<int,max-min+1> positions = make();
+
+    static int call(E e){
+        unsigned long long u = static_cast<unsigned long long>(static_cast<long long>(static_cast<U>(e))-min);
+        return u <= static_cast<unsigned long long>(max-min) ? positions[u] : 0;
+    }
+};
+
+template<typename E, E... VS>
+struct enum_position{
+
+    using U = typename underlying_value<typename std::is_enum<E>::type,E>::type;
+    static constexpr long long range = std::max({static_cast<long long>(static_cast<U>(VS))...})
+                                      -std::min({static_cast<long long>(static_cast<U>(VS))...});
+
+    static int call(E e){
+        return enum_position_aux<std::bool_constant<(range < 256)>,E,VS...>::call(e);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the position of an object in a list from TID. If the list belongs to a polymorphic type, the
+*   most derived type of the object is looked for. If it belongs to an enum_value, its value is looked for.
+*   If it belongs to a type-erased adapter, the type of the contained object is looked for (or the
+*   position of the adapter if it is not listed).
+*    - T : A list from TID.
+*    - A : The type of the object.
+*    - a : The object.
+*/
+template<typename IsErased, typename T, typename A>
+struct position_runtime_aux{
+    static int call(A&& a){
+        return position_derived_runtime<T>::call(get_type_id<A>::call(std::forward<A>(a)));
+    }
+};
+
+template<typename T, typename A>
+struct position_runtime_aux<std::true_type,T,A>{
+    static int call(A&& a){
+        int k = position_derived_runtime<T>::call(virtual_adapter_of<A>::type_id(a));
+        return k < length_v<T> ? k : 0;
+    }
+};
+
+template<typename T, typename A>
+struct position_runtime : position_runtime_aux<is_erased_adapter_t<car_t<T>>,T,A>{};
+
+template<typename E, E... VS, typename S, typename A>
+struct position_runtime<cons<enum_value<E,VS...>,S>,A>{
+    static int call(A&& a){
+        return enum_position<E,VS...>::call(a);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the index where the implementation that must be called is. The objects are only inspected,
+*   so they are received as lvalues and forwarded to the implementation just once, by the caller.
+*    - TID : The TID type.
+*    - VBS : The VBS type.
+*    - AS... : The types of the arguments that will be passed to the implementation.
+*    - as... : The objects that will be passed to the implementation.
+*/
+template<typename Tid, typename VBS, typename... AS>
+struct get_index_aux{
+    static constexpr int current_multiplier = 1;
+    static int call(AS&&... as){
+        return 0;
+    }
+};
+
+template<typename Tid, typename B, typename BS, typename A, typename... AS>
+struct get_index_aux<Tid,cons<B,BS>,A,AS...>{
+    static constexpr int current_multiplier = get_index_aux<Tid,BS,AS...>::current_multiplier;
+    static int call(A&& a, AS&&... as){
+        return get_index_aux<Tid,BS,AS...>::call(std::forward<AS>(as)...);
+    }
+};
+
+template<typename T, typename TS, typename B, typename BS, typename A, typename... AS>
+struct get_index_aux<cons<T,TS>,cons<virtual_type<B>,BS>,A,AS...>{
+    static constexpr int current_multiplier = get_index_aux<TS,BS,AS...>::current_multiplier*length_v<T>;
+    static int call(A&& a, AS&&... as){
+        return get_index_aux<TS,BS,AS...>::call(std::forward<AS>(as)...)
+               + position_runtime<T,A>::call(std::forward<A>(a))*get_index_aux<TS,BS,AS...>::current_multiplier;
+    }
+};
+
+template<typename Tid, typename VBS, typename... AS>
+struct get_index{
+    static int call(AS&&... as){
+        return get_index_aux<Tid,cdr_t<VBS>,AS...>::call(std::forward<AS>(as)...);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether looking for the cell of some arguments cannot throw. The virtual arguments that are
+*   pointers or adapters (but not type-erased adapters) are dereferenced, and typeid throws std::bad_typeid
+*   if they are null.
+*    - VBS : The VBS type without the return type.
+*    - AS... : The types of the arguments.
+*/
+template<typename VBS, typename... AS>
+struct nothrow_lookup : std::true_type{};
+
+template<typename B, typename BS, typename A, typename... AS>
+struct nothrow_lookup<cons<B,BS>,A,AS...> : nothrow_lookup<BS,AS...>{};
+
+template<typename B, typename BS, typename A, typename... AS>
+struct nothrow_lookup<cons<virtual_type<B>,BS>,A,AS...>
+    : std::bool_constant<!std::is_pointer<std::remove_reference_t<A>>::value && !(virtual_adapter_of<A>::value && !is_erased_adapter_v<A>) &&
+                         nothrow_lookup<BS,AS...>::value>{};
+
+template<typename VBS, typename... AS>
+static constexpr bool nothrow_lookup_v = nothrow_lookup<cdr_t<VBS>,AS...>::value;
+
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the index where the implementation that must be called is, when the most derived
+*   types of the virtual arguments are known in compile time.
+*    - Tid : The TID type.
+*    - DL : A list with the most derived type of each virtual argument.
+*/
+template<typename Tid, typename DL>
+struct static_index : zero{};
+
+template<typename T, typename TS, typename D, typename DS>
+struct static_index<cons<T,TS>,cons<D,DS>> : int_constant<position_v<D,T>*table_length_v<TS> + static_index<TS,DS>::value>{};
+
+template<typename Tid, typename DL>
+static constexpr int static_index_v = static_index<Tid,DL>::value;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the index where the implementation that must be called is, from the slot of each virtual
+*   argument, i.e. its position in its list of TID.
+*    - Tid : The TID type.
+*    - ss... : The slots.
+*/
+template<typename Tid>
+struct slots_index{
+    static constexpr int call(){
+        return 0;
+    }
+};
+
+template<typename T, typename TS>
+struct slots_index<cons<T,TS>>{
+    template<typename... SS>
+    static constexpr int call(int s, SS... ss){
+        return s*table_length_v<TS> + slots_index<TS>::call(ss...);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//------------------------------ Next implementation ------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the type of a list of TID that a parameter of an implementation receives. It is the core
+*   type of the parameter, except for the enum of an enum_value, which is the enum_value itself.
+*    - B : The virtual base type of the parameter.
+*    - D : The core type of the parameter.
+*/
+template<typename B, typename D>
+struct parameter_type_id{
+    using type = D;
+};
+
+template<typename E, E... VS>
+struct parameter_type_id<enum_value<E,VS...>,E> : enum_value<E,VS...>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns a list with the type from TID of each virtual parameter of an implementation, given the
+*   arguments it receives.
+*    - VBS : The VBS type without the return type.
+*    - AS... : The types of the arguments.
+*/
+template<typename VBS, typename... AS>
+struct parameter_type_ids : nil{};
+
+template<typename B, typename BS, typename A, typename... AS>
+struct parameter_type_ids<cons<B,BS>,A,AS...> : parameter_type_ids<BS,AS...>{};
+
+template<typename B, typename BS, typename A, typename... AS>
+struct parameter_type_ids<cons<virtual_type<B>,BS>,A,AS...> : cons<typename parameter_type_id<B,core_type_t<A>>::type,
+                                                                    typename parameter_type_ids<BS,AS...>::type>{};
+
+template<typename VBS, typename... AS>
+using parameter_type_ids_t = typename parameter_type_ids<VBS,AS...>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether every type of a list belongs to the corresponding list of TID.
+*    - Tid : The TID type.
+*    - DL : A list with a type per virtual argument.
+*/
+template<typename Tid, typename DL>
+struct belongs_to_type_id : std::true_type{};
+
+template<typename T, typename TS, typename D, typename DS>
+struct belongs_to_type_id<cons<T,TS>,cons<D,DS>> : std::bool_constant<(position_v<D,T> >= 0) && belongs_to_type_id<TS,DS>::value>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether a parameter of type X accepts an argument of type D better than a parameter of type Y.
+*    - D : The type of the argument.
+*    - X : The type of the first parameter.
+*    - Y : The type of the second parameter, different from X.
+*/
+template<typename X, typename Y>
+struct parameter_rank_probe{
+    static std::true_type test(X);
+    static std::false_type test(Y);
+};
+
+template<typename D, typename X, typename Y, typename = void>
+struct better_parameter : std::false_type{};
+
+template<typename D, typename X, typename Y>
+struct better_parameter<D,X,Y,std::void_t<decltype(parameter_rank_probe<X,Y>::test(std::declval<D>()))>>
+    : decltype(parameter_rank_probe<X,Y>::test(std::declval<D>())){};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   An argument that converts to the references and pointers X accepting an argument of type D at least as
+*   well as a parameter of type N. If Excluded is true, it does not convert to D itself. The arguments of the
+*   cell are replaced by them to find the overloads of F that accept them, including the ones that are not
+*   in IMPL (see next_implementation_checked).
+*    - D : The type of the argument of the cell.
+*    - N : The type of the parameter of the next implementation.
+*    - Excluded : A bool_constant indicating whether D itself is excluded.
+*/
+template<typename D, typename N, typename Excluded>
+struct next_probe_argument{
+
+    template<typename X>
+    static constexpr bool converts = std::is_convertible<D,X>::value && !(Excluded::value && std::is_same<X,D>::value) &&
+                                     std::disjunction<std::is_same<X,N>,better_parameter<D,X,N>>::value;
+
+    template<typename T, typename = std::enable_if_t<std::is_reference<D>::value && converts<T&>>>
+    operator T&() const;
+
+    template<typename T, typename = std::enable_if_t<std::is_rvalue_reference<D>::value && converts<T&&>>>
+    operator T&&() const;
+
+    template<typename T, typename = std::enable_if_t<std::is_pointer<D>::value && converts<T*>>>
+    operator T*() const;
+};
+
+/**
+*   The argument of the probe for the parameter in the position I. Only the references and the pointers are
+*   replaced, and only the parameter in the position E excludes the type of the cell.
+*/
+template<bool IsReplaced, std::size_t I, std::size_t E, typename D, typename N>
+struct next_probe_argument_type{
+    using type = D;
+};
+
+template<std::size_t I, std::size_t E, typename D, typename N>
+struct next_probe_argument_type<true,I,E,D,N>{
+    using type = next_probe_argument<D,N,std::bool_constant<I == E>>;
+};
+
+template<std::size_t I, std::size_t E, typename D, typename N>
+using next_probe_argument_t = typename next_probe_argument_type<std::is_reference<D>::value || std::is_pointer<D>::value,I,E,D,N>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks that the overload resolution would select the next implementation if the current one did not
+*   exist. For each position E of a reference or a pointer, every overload of F taking the same type as the
+*   current implementation in E is left out by replacing the arguments (see next_probe_argument), so the
+*   overloads that remain are the ones accepting the cell at least as well as the next implementation. The
+*   replaced arguments go through a different conversion for each overload, so the call is ambiguous if
+*   more than one remains. The next implementation is returned if it is the only one, and the ellipsis if
+*   there is none.
+*    - F : The struct containing all the implementations.
+*    - DC : The signature of the current implementation (the cell) as a collection.
+*    - NC : The signature of the next implementation as a collection.
+*/
+template<typename F, typename NC>
+struct next_implementation_probe : implementation_probe<F,NC>{
+    using implementation_probe<F,NC>::implementation;
+    static no_implementation_tag implementation(...);
+};
+
+template<typename F, typename DC, typename NC, typename IS>
+struct next_implementation_checked{};
+
+template<typename F, typename R, typename... Dargs, typename S, typename... Nargs, std::size_t... IS>
+struct next_implementation_checked<F,collection<R,Dargs...>,collection<S,Nargs...>,std::index_sequence<IS...>>{
+
+    template<std::size_t E>
+    using result = typename next_probe_result<next_implementation_probe<F,collection<S,Nargs...>>,
+                                              collection<next_probe_argument_t<IS,E,Dargs,Nargs>...>>::type;
+
+    static constexpr bool replaced[] = {(std::is_reference<Dargs>::value || std::is_pointer<Dargs>::value)...,false};
+
+    template<std::size_t E>
+    static constexpr bool selected = !replaced[E] || std::is_same<result<E>,selected_implementation_tag>::value ||
+                                                     std::is_same<result<E>,no_implementation_tag>::value;
+
+    static constexpr bool value = (selected<IS> && ...);
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Finds in compile time the implementation called by call_next. The arguments are the parameters of
+*   an implementation, so their static types tell its cell. The next implementation is the most specific
+*   of the rest of implementations accepting that cell. It must exist and be unique.
+*    - F : The struct containing all the implementations.
+*    - TID : The TID type.
+*    - VBS : The VBS type.
+*    - DSCOMB : The DSCOMB type.
+*    - AS... : The types of the arguments.
+*/
+template<typename F, typename TID, typename VBS, typename DSCOMB, typename... AS>
+struct next_implementation{
+    using DL = parameter_type_ids_t<cdr_t<VBS>,AS...>;
+    static constexpr bool known = sizeof...(AS) == length_v<cdr_t<VBS>> && belongs_to_type_id<TID,DL>::value;
+    static_assert(known,"omm: call_next must receive the parameters of an implementation");
+
+    using KEYS = scatter_implementation_keys<F,VBS,TID,DSCOMB>;
+    static constexpr int cell = known ? static_index_v<TID,DL> : 0;
+    static_assert(!known || KEYS::exact[cell],"omm: call_next must receive the parameters of an implementation");
+
+    static constexpr int key = KEYS::exact[cell] ? KEYS::next[cell] : 0;
+    static_assert(key >= 0,"omm: there is no next implementation, or it is ambiguous");
+
+    using type = nth_t<exact_implementations_t<F,VBS,TID>,int_constant<(key >= 0 ? key : 0)>>;
+
+    static_assert(key < 0 || next_implementation_checked<F,tlist_to_collection_t<nth_t<DSCOMB,int_constant<cell>>>,tlist_to_collection_t<type>,
+                                                         std::make_index_sequence<length_v<cdr_t<VBS>>>>::value,
+                  "omm: an overload of the implementations that is not in the omm table is called instead of the next implementation "
+                  "(pass the types of its parameters to WithDerivedTypes)");
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls the implementation with the signature NS directly. The arguments are cast to its parameters
+*   like the upcasts of a usual call, so the call can be inlined.
+*    - F : The struct containing all the implementations.
+*    - NS : The signature of the next implementation as a collection.
+*/
+template<typename F, typename NS>
+struct next_implementation_call{};
+
+template<typename F, typename R, typename... Nargs>
+struct next_implementation_call<F,collection<R,Nargs...>>{
+    using function_type = std::conditional_t<has_nothrow_implementation<F,collection<R,Nargs...>>::value,
+                                             R(*)(Nargs...) noexcept,R(*)(Nargs...)>;
+    static constexpr function_type function = static_cast<function_type>(&F::implementation);
+
+    template<typename... AS>
+    static constexpr bool nothrow = noexcept(function(static_cast<Nargs>(std::declval<AS>())...));
+
+    template<typename... AS>
+    static R call(AS&&... as) noexcept(nothrow<AS...>){
+        return function(static_cast<Nargs>(std::forward<AS>(as))...);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//-------------------------------- Decision tree ----------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether all the cells in a range of the omm table call the same implementation from IMPL.
+*    - keys : The keys array.
+*    - first : The first cell of the range.
+*    - count : The number of cells in the range.
+*/
+constexpr bool is_uniform_range(const int* keys, int first, int count){
+    for (int i = 1; i < count; ++i)
+        if (keys[first+i] != keys[first])
+            return false;
+    return keys[first] >= 0;
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates a level of the decision tree. A level is an array with a function pointer per possible
+*   combination of the virtual arguments identified so far. The function pointer is nullptr if
+*   the remaining virtual arguments are needed to know which implementation must be called.
+*   With lazy_encoding, the functions are not stored: a level only tells which elements cover cells that
+*   call the same implementation, and the function is read from the first of them (see lazy_table).
+*    - T : The omm table.
+*    - Stride : The number of cells that each element of the level covers.
+*    - Count : The number of elements of the level.
+*    - prefix : The element of the level.
+*/
+template<typename T, int Stride, int Count, typename IsLazy = typename std::is_same<typename T::ENCODING,lazy_encoding>::type>
+struct tree_level{
+
+    using function_pointer = std::remove_const_t<std::remove_pointer_t<decltype(T::table)>>;
+
+    static constexpr std::array<function_pointer,Count> make(){
+        std::array<function_pointer,Count> level{};
+        for (int k = 0; k < Count; ++k)
+            level[k] = is_uniform_range(T::keys,k*Stride,Stride) ? T::table[k*Stride] : nullptr;
+        return level;
+    }
+
+    static constexpr std::array<function_pointer,Count> value = make();
+
+    static auto at(int prefix) noexcept{
+        return value[prefix];
+    }
+};
+
+template<typename T, int Stride, int Count>
+struct tree_level<T,Stride,Count,std::true_type>{
+
+    static constexpr std::array<bool,Count> make(){
+        std::array<bool,Count> level{};
+        for (int k = 0; k < Count; ++k)
+            level[k] = is_uniform_range(T::keys,k*Stride,Stride);
+        return level;
+    }
+
+    static constexpr std::array<bool,Count> value = make();
+
+    static auto at(int prefix) noexcept{
+        return value[prefix] ? T::cell(prefix*Stride) : nullptr;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the function pointer that must be called. Unlike get_index, the virtual arguments are
+*   identified one by one, and it stops as soon as all the remaining cells call the same implementation.
+*   Like get_index, it receives the objects as lvalues.
+*    - T : The omm table.
+*    - Tid : The lists from TID whose virtual arguments have not been identified yet.
+*    - VBS : The types from the VBS that have not been visited yet.
+*    - AS... : The types of the arguments that will be passed to the implementation.
+*    - prefix : The index of the virtual arguments identified so far.
+*    - cell : Receives the first cell of the range where it stopped (used by OMM_TRACE).
+*    - as... : The objects that will be passed to the implementation.
+*/
+template<typename T, typename Tid, typename VBS, typename... AS>
+struct tree_lookup_aux{
+    static auto call(int prefix, int& cell, AS&&... as){
+        cell = prefix;
+        return T::cell(prefix);
+    }
+};
+
+template<typename T, typename Tid, typename B, typename BS, typename A, typename... AS>
+struct tree_lookup_aux<T,Tid,cons<B,BS>,A,AS...>{
+    static auto call(int prefix, int& cell, A&&, AS&&... as){
+        return tree_lookup_aux<T,Tid,BS,AS...>::call(prefix,cell,std::forward<AS>(as)...);
+    }
+};
+
+template<typename T, typename R, typename RS, typename B, typename BS, typename A, typename... AS>
+struct tree_lookup_aux<T,cons<R,RS>,cons<virtual_type<B>,BS>,A,AS...>{
+    static constexpr int stride = table_length_v<cons<R,RS>>;
+    static auto call(int prefix, int& cell, A&& a, AS&&... as){
+        if (auto f = tree_level<T,stride,T::cells/stride>::at(prefix)){
+            cell = prefix*stride;
+            return f;
+        }
+        return tree_lookup_aux<T,RS,BS,AS...>::call(prefix*length_v<R> + position_runtime<R,A>::call(std::forward<A>(a)),
+                                                    cell,std::forward<AS>(as)...);
+    }
+};
+
+template<typename T, typename... AS>
+struct tree_lookup{
+    static auto call(int& cell, AS&&... as){
+        return tree_lookup_aux<T,typename T::TID,cdr_t<typename T::VBS>,AS...>::call(0,cell,std::forward<AS>(as)...);
+    }
+
+    static auto call(AS&&... as){
+        int cell;
+        return call(cell,std::forward<AS>(as)...);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//----------------------------- Dispatch strategies -------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   The ways an omm table can find the implementation to call:
+*    - table_strategy : Identifies every virtual argument and reads the omm table (see get_index).
+*    - tree_strategy : Identifies the virtual arguments one by one until the implementation is known
+*                      (see tree_lookup).
+*    - automatic_strategy : Chooses one of them from the estimated cost of each one (see select_strategy).
+*/
+struct table_strategy{
+    static constexpr const char* name = "table";
+};
+
+struct tree_strategy{
+    static constexpr const char* name = "tree";
+};
+
+struct automatic_strategy{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Estimates the cost of each strategy as the number of steps per call, assuming that every cell is
+*   called with the same frequency. Identifying an argument takes one step to read its type (typeid or
+*   the value) plus (n+1)/2 comparisons on average, where n is the length of its list in TID. The
+*   decision tree only reaches the arguments of the cells that are not known yet, but it also checks a
+*   level before each argument but the first. That check is usually folded by the compiler into the
+*   comparisons of the previous argument, so it costs a quarter.
+*    - Tid : The lists from TID that have not been visited yet.
+*    - keys : The keys array.
+*    - cells : The number of cells of the omm table.
+*    - check : The cost of checking the level before the first list of Tid.
+*/
+template<typename Tid>
+struct dispatch_cost{
+
+    static constexpr double table(){
+        return 0.0;
+    }
+
+    static constexpr double tree(const int*, int, double = 0.0){
+        return 0.0;
+    }
+
+    static constexpr int tree_levels(int){
+        return 0;
+    }
+};
+
+template<typename R, typename RS>
+struct dispatch_cost<cons<R,RS>>{
+
+    static constexpr int stride = table_length_v<cons<R,RS>>;
+    static constexpr double lookup = 1+(length_v<R>+1)/2.0;
+
+    static constexpr double table(){
+        return lookup + dispatch_cost<RS>::table();
+    }
+
+    static constexpr double tree(const int* keys, int cells, double check = 0.0){
+        int reached = 0;
+        for (int first = 0; first < cells; first += stride)
+            if (!is_uniform_range(keys,first,stride))
+                reached += stride;
+        return (check+lookup)*reached/cells + dispatch_cost<RS>::tree(keys,cells,0.25);
+    }
+
+    static constexpr int tree_levels(int cells){
+        return cells/stride + dispatch_cost<RS>::tree_levels(cells);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the strategy used by an omm table. The automatic strategy chooses the decision tree only if
+*   it needs fewer steps per call. When both need the same steps (always with one virtual argument),
+*   the omm table is chosen, since it reads the cell with one load instead of one per level.
+*    - S : The strategy passed to the omm table.
+*    - TID : The TID type.
+*    - KEYS : The type holding the keys array.
+*/
+template<typename S, typename TID, typename KEYS>
+struct select_strategy{
+    using type = S;
+};
+
+template<typename TID, typename KEYS>
+struct select_strategy<automatic_strategy,TID,KEYS>{
+    static constexpr bool tree = dispatch_cost<TID>::tree(&KEYS::value[0],table_length_v<TID>) < dispatch_cost<TID>::table();
+    using type = std::conditional_t<tree,tree_strategy,table_strategy>;
+};
+
+template<typename S, typename TID, typename KEYS>
+using select_strategy_t = typename select_strategy<S,TID,KEYS>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Describes how an omm table dispatches its calls:
+*    - strategy : The name of the strategy used by call.
+*    - encoding : The name of the encoding of the omm table.
+*    - dimensions : The number of virtual arguments.
+*    - cells : The number of cells of the omm table.
+*    - implementations : The number of implementations written by the user that the table calls.
+*    - thunks : The number of different functions in the omm table.
+*    - fill_ratio : The fraction of cells with their own implementation.
+*    - table_bytes : The size of the omm table.
+*    - tree_bytes : The size of the levels of the decision tree.
+*    - table_cost : The estimated steps per call of the table strategy (see dispatch_cost).
+*    - tree_cost : The estimated steps per call of the tree strategy (see dispatch_cost).
+*/
+struct dispatch_layout{
+    const char* strategy;
+    const char* encoding;
+    int dimensions;
+    int cells;
+    int implementations;
+    int thunks;
+    double fill_ratio;
+    std::size_t table_bytes;
+    std::size_t tree_bytes;
+    double table_cost;
+    double tree_cost;
+};
+
+/**
+*   Calls the implementation with the strategy S.
+*    - S : The strategy.
+*    - T : The omm table.
+*/
+template<typename S, typename T>
+struct strategy_call{
+    template<typename... AS>
+    static auto call(AS&&... as){
+        return T::table_call(std::forward<AS>(as)...);
+    }
+};
+
+template<typename T>
+struct strategy_call<tree_strategy,T>{
+    template<typename... AS>
+    static auto call(AS&&... as){
+        return T::tree_call(std::forward<AS>(as)...);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//----------------------------- Performance counters ------------------------------
+//---------------------------------------------------------------------------------
+
+#ifdef OMM_PERF_COUNTERS
+
+/**
+*   The hardware events counted around each call when OMM_PERF_COUNTERS is defined.
+*/
+enum class dispatch_event{
+    branch_misses,
+    instructions,
+    icache_misses
+};
+
+static constexpr int dispatch_events = 3;
+
+inline const char* dispatch_event_name(dispatch_event e){
+    static const char* names[dispatch_events] = {"branch-misses","instructions","icache-misses"};
+    return names[static_cast<int>(e)];
+}
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The hardware counters of the current thread, opened with perf_event_open as a group. The events
+*   that can not be opened (in other systems, in containers...) are always zero.
+*/
+struct thread_perf_events{
+
+    int leader = -1;
+    int fds[dispatch_events] = {-1,-1,-1};
+    int slots[dispatch_events] = {-1,-1,-1};
+    int opened = 0;
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+    thread_perf_events(){
+        static const std::uint32_t types[dispatch_events] = {PERF_TYPE_HARDWARE,PERF_TYPE_HARDWARE,PERF_TYPE_HW_CACHE};
+        static const std::uint64_t configs[dispatch_events] = {PERF_COUNT_HW_BRANCH_MISSES,PERF_COUNT_HW_INSTRUCTIONS,
+                                                              PERF_COUNT_HW_CACHE_L1I | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        for (int e = 0; e < dispatch_events; ++e){
+            perf_event_attr attr;
+            std::memset(&attr,0,sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[e] = static_cast<int>(syscall(__NR_perf_event_open,&attr,0,-1,leader,0));
+            if (fds[e] < 0)
+                continue;
+            if (leader < 0)
+                leader = fds[e];
+            slots[e] = opened++;
+        }
+    }
+
+    ~thread_perf_events(){
+        for (int e = dispatch_events-1; e >= 0; --e)
+            if (fds[e] >= 0)
+                close(fds[e]);
+    }
+
+    void read_values(std::uint64_t (&values)[dispatch_events]) const{
+        std::uint64_t data[1+dispatch_events] = {};
+        if (leader < 0 || ::read(leader,data,sizeof(data)) < static_cast<ssize_t>((1+opened)*sizeof(std::uint64_t)))
+            clear(values);
+        else
+            for (int e = 0; e < dispatch_events; ++e)
+                values[e] = slots[e] < 0 ? 0 : data[1+slots[e]];
+    }
+#else
+    void read_values(std::uint64_t (&values)[dispatch_events]) const{
+        clear(values);
+    }
+#endif
+
+    thread_perf_events(const thread_perf_events&) = delete;
+    thread_perf_events& operator=(const thread_perf_events&) = delete;
+
+    static void clear(std::uint64_t (&values)[dispatch_events]){
+        for (int e = 0; e < dispatch_events; ++e)
+            values[e] = 0;
+    }
+
+    bool available(dispatch_event e) const{
+        return slots[static_cast<int>(e)] >= 0;
+    }
+
+    static thread_perf_events& local(){
+        static thread_local thread_perf_events events;
+        return events;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The counts of a method in a thread. Only the thread that owns them writes them, so relaxed atomics
+*   are enough for other threads to read them.
+*    - calls : The number of calls.
+*    - lookup : The events while looking for the cell of the omm table (get_index or the decision tree).
+*    - total : The events of the whole call, including the implementation.
+*   Each one takes its own cache line, so the threads never write to the same line.
+*/
+struct alignas(64) dispatch_counter_cell{
+
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> lookup[dispatch_events] = {};
+    std::atomic<std::uint64_t> total[dispatch_events] = {};
+
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value){
+        counter.store(counter.load(std::memory_order_relaxed)+value,std::memory_order_relaxed);
+    }
+};
+
+struct dispatch_counter_record{
+    std::string method;
+    std::thread::id thread;
+    std::uint64_t calls;
+    std::uint64_t lookup[dispatch_events];
+    std::uint64_t total[dispatch_events];
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Keeps the counts of every method in every thread. The counts are never removed, so they survive
+*   the threads that created them.
+*/
+struct dispatch_counter_registry{
+
+    struct entry{
+        entry(const std::string& method, std::thread::id thread) : method(method), thread(thread){}
+        std::string method;
+        std::thread::id thread;
+        dispatch_counter_cell cell;
+    };
+
+    std::mutex mutex;
+    std::deque<entry> entries;
+
+    dispatch_counter_cell& add(const std::string& method){
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.emplace_back(method,std::this_thread::get_id());
+        return entries.back().cell;
+    }
+
+    static dispatch_counter_registry& instance(){
+        static dispatch_counter_registry* registry = new dispatch_counter_registry;
+        return *registry;
+    }
+};
+
+/**
+*   Returns the counts of a method in the current thread. The method is named after the struct with the
+*   implementations and the signature of the omm table.
+*    - F : The struct containing all the implementations.
+*    - BS : The BS type.
+*/
+template<typename F, typename BS>
+struct method_perf_counters{
+    static dispatch_counter_cell& local(){
+        static const std::string name = type_name(typeid(F)) + " " + type_name(typeid(signature_to_function_type_t<BS>));
+        static thread_local dispatch_counter_cell& cell = dispatch_counter_registry::instance().add(name);
+        return cell;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Reads the counters at the beginning of a call, after the lookup and at the end of the call. If the
+*   lookup throws (std::bad_typeid for a null pointer), no implementation is called and nothing is counted.
+*/
+struct dispatch_probe{
+
+    dispatch_counter_cell& cell;
+    const thread_perf_events& events = thread_perf_events::local();
+    std::uint64_t start[dispatch_events];
+    std::uint64_t lookup[dispatch_events];
+    bool looked_up = false;
+
+    dispatch_probe(dispatch_counter_cell& cell) : cell(cell){
+        events.read_values(start);
+    }
+
+    void lookup_done(){
+        events.read_values(lookup);
+        looked_up = true;
+    }
+
+    ~dispatch_probe(){
+        if (!looked_up)
+            return;
+        std::uint64_t end[dispatch_events];
+        events.read_values(end);
+        dispatch_counter_cell::add(cell.calls,1);
+        for (int e = 0; e < dispatch_events; ++e){
+            dispatch_counter_cell::add(cell.lookup[e],lookup[e]-start[e]);
+            dispatch_counter_cell::add(cell.total[e],end[e]-start[e]);
+        }
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Query and report API:
+*    - dispatch_counters_available : Whether an event can be counted in the current thread.
+*    - dispatch_counter_snapshot : Returns the counts of every method in every thread.
+*    - reset_dispatch_counters : Sets every count to zero.
+*    - report_dispatch_counters : Prints the counts per call of every method, in total and per thread.
+*   The counts include the cost of reading the counters, which is the same in every call.
+*/
+inline bool dispatch_counters_available(dispatch_event e){
+    return thread_perf_events::local().available(e);
+}
+
+inline std::vector<dispatch_counter_record> dispatch_counter_snapshot(){
+    dispatch_counter_registry& registry = dispatch_counter_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<dispatch_counter_record> records;
+    for (auto& entry : registry.entries){
+        dispatch_counter_record record{entry.method,entry.thread,entry.cell.calls.load(std::memory_order_relaxed),{},{}};
+        for (int e = 0; e < dispatch_events; ++e){
+            record.lookup[e] = entry.cell.lookup[e].load(std::memory_order_relaxed);
+            record.total[e] = entry.cell.total[e].load(std::memory_order_relaxed);
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+
+inline void reset_dispatch_counters(){
+    dispatch_counter_registry& registry = dispatch_counter_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& entry : registry.entries){
+        entry.cell.calls.store(0,std::memory_order_relaxed);
+        for (int e = 0; e < dispatch_events; ++e){
+            entry.cell.lookup[e].store(0,std::memory_order_relaxed);
+            entry.cell.total[e].store(0,std::memory_order_relaxed);
+        }
+    }
+}
+
+inline void report_dispatch_counters(std::FILE* out = stderr){
+
+    auto print = [out](const dispatch_counter_record& r, const char* indent){
+        std::fprintf(out,"%scalls: %llu\n",indent,static_cast<unsigned long long>(r.calls));
+        for (int e = 0; e < dispatch_events; ++e){
+            double calls = r.calls ? static_cast<double>(r.calls) : 1.0;
+            std::fprintf(out,"%s  %-14s lookup: %10.3f  call: %10.3f  per call\n",indent,dispatch_event_name(static_cast<dispatch_event>(e)),
+                         r.lookup[e]/calls,r.total[e]/calls);
+        }
+    };
+
+    std::vector<dispatch_counter_record> records = dispatch_counter_snapshot();
+    std::vector<dispatch_counter_record> methods;
+    for (auto& r : records){
+        auto m = std::find_if(methods.begin(),methods.end(),[&](const dispatch_counter_record& x){ return x.method == r.method; });
+        if (m == methods.end()){
+            methods.push_back(r);
+            continue;
+        }
+        m->calls += r.calls;
+        for (int e = 0; e < dispatch_events; ++e){
+            m->lookup[e] += r.lookup[e];
+            m->total[e] += r.total[e];
+        }
+    }
+
+    for (int e = 0; e < dispatch_events; ++e)
+        if (!dispatch_counters_available(static_cast<dispatch_event>(e)))
+            std::fprintf(out,"omm: %s can not be counted\n",dispatch_event_name(static_cast<dispatch_event>(e)));
+
+    for (auto& m : methods){
+        std::fprintf(out,"%s\n",m.method.c_str());
+        print(m,"  ");
+        int k = 0;
+        for (auto& r : records)
+            if (r.method == m.method){
+                std::fprintf(out,"  thread %d\n",k++);
+                print(r,"    ");
+            }
+    }
+}
+
+#endif // OMM_PERF_COUNTERS
+
+
+//---------------------------------------------------------------------------------
+//---------------------------------- Dispatch trace -------------------------------
+//---------------------------------------------------------------------------------
+
+#ifdef OMM_TRACE
+
+#ifndef OMM_TRACE_CAPACITY
+#define OMM_TRACE_CAPACITY 4096
+#endif
+
+#ifndef OMM_TRACE_THREADS
+#define OMM_TRACE_THREADS 64
+#endif
+
+static_assert(OMM_TRACE_CAPACITY > 0 && (OMM_TRACE_CAPACITY & (OMM_TRACE_CAPACITY-1)) == 0,
+              "OMM_TRACE_CAPACITY must be a power of two");
+static_assert(OMM_TRACE_THREADS > 0,"OMM_TRACE_THREADS must be positive");
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Describes a traced method. Its address identifies the method in the trace, and its functions
+*   are only called to decode the trace.
+*    - name : The struct with the implementations and the signature of the omm table.
+*    - cell_name : The signature of a cell, taken from DSCOMB.
+*/
+struct dispatch_trace_method{
+    std::string (*name)();
+    std::string (*cell_name)(int cell);
+};
+
+template<typename DSCOMB>
+struct dispatch_signature_names;
+
+template<typename... DS>
+struct dispatch_signature_names<collection<DS...>>{
+    static std::vector<std::string> call(){
+        return {type_name(typeid(signature_to_function_type_t<DS>))...};
+    }
+};
+
+/**
+*   The description of the method of an omm table, a constant with no initialization at runtime.
+*    - F : The struct containing all the implementations.
+*    - BS : The BS type.
+*    - DSCOMB : The DSCOMB type.
+*/
+template<typename F, typename BS, typename DSCOMB>
+struct method_trace{
+
+    static std::string name(){
+        return type_name(typeid(F)) + " " + type_name(typeid(signature_to_function_type_t<BS>));
+    }
+
+    static std::string cell_name(int cell){
+        static const std::vector<std::string> names = dispatch_signature_names<tlist_to_collection_t<DSCOMB>>::call();
+        return cell >= 0 && cell < static_cast<int>(names.size()) ? names[cell] : "?";
+    }
+
+    static constexpr dispatch_trace_method method = {&name,&cell_name};
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The last calls of a thread. Only the thread writes its ring, with relaxed atomics so other threads
+*   can read it, like a seqlock: started is published before an entry is written, so a reader knows
+*   which entries may have been overwritten while it copied them, and next after it is written. The ring
+*   needs no initialization at runtime: the id of the thread is only constructed when a thread takes the ring.
+*/
+struct dispatch_trace_ring{
+
+    struct entry{
+        std::atomic<const dispatch_trace_method*> method{nullptr};
+        std::atomic<std::uint64_t> timestamp{0};
+        std::atomic<int> cell{0};
+    };
+
+    static constexpr std::uint64_t capacity = OMM_TRACE_CAPACITY;
+
+    union owner_id{
+        char unclaimed;
+        std::thread::id thread;
+        constexpr owner_id() noexcept : unclaimed(0){}
+    };
+
+    owner_id owner;
+    std::atomic<bool> ready{false};
+    std::atomic<std::uint64_t> started{0};
+    std::atomic<std::uint64_t> next{0};
+    entry entries[capacity];
+
+    void add(const dispatch_trace_method* method, int cell) noexcept{
+        std::uint64_t n = next.load(std::memory_order_relaxed);
+        entry& e = entries[n & (capacity-1)];
+        started.store(n+1,std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        e.method.store(method,std::memory_order_relaxed);
+        e.cell.store(cell,std::memory_order_relaxed);
+        e.timestamp.store(dispatch_timestamp(),std::memory_order_relaxed);
+        next.store(n+1,std::memory_order_release);
+    }
+};
+
+/**
+*   The rings of OMM_TRACE_THREADS threads, in static memory, so the system only gives memory to the
+*   rings that are used. Each thread takes the next ring in its first call, without locking or
+*   allocating, and keeps it after it finishes. The threads that come after the last ring write in
+*   the overflow ring, which is not reported.
+*/
+struct dispatch_trace_registry{
+
+    static constexpr int threads = OMM_TRACE_THREADS;
+
+    std::atomic<int> used{0};
+    dispatch_trace_ring rings[threads];
+    dispatch_trace_ring overflow;
+
+    dispatch_trace_ring* add() noexcept{
+        int n = used.fetch_add(1,std::memory_order_relaxed);
+        if (n >= threads)
+            return &overflow;
+        dispatch_trace_ring& ring = rings[n];
+        new (&ring.owner.thread) std::thread::id(std::this_thread::get_id());
+        ring.ready.store(true,std::memory_order_release);
+        return &ring;
+    }
+
+    static dispatch_trace_registry& instance() noexcept{
+        static dispatch_trace_registry registry;
+        return registry;
+    }
+};
+
+/**
+*   Records a call in the ring of the current thread. The first call of each thread takes its ring
+*   (see dispatch_trace_first_call), and the rest of calls only take a timestamp and store the entry.
+*/
+inline dispatch_trace_ring* dispatch_trace_first_call() noexcept{
+    dispatch_clock_origin::instance();
+    return dispatch_trace_registry::instance().add();
+}
+
+inline void dispatch_trace(const dispatch_trace_method* method, int cell) noexcept{
+    static thread_local dispatch_trace_ring* ring = nullptr;
+    if (!ring)
+        ring = dispatch_trace_first_call();
+    ring->add(method,cell);
+}
+
+//---------------------------------------------------------------------------------
+
+struct dispatch_trace_record{
+    std::thread::id thread;
+    std::uint64_t timestamp;
+    std::string method;
+    int cell;
+    std::string cell_signature;
+};
+
+/**
+*   Query and report API:
+*    - dispatch_trace_snapshot : Returns the calls kept by the rings of every thread, decoded and
+*      sorted by timestamp. The calls written while the snapshot is taken may be left out.
+*    - report_dispatch_trace : Prints the last calls, with the time before the last one.
+*   The tree strategy records the first cell of the range of cells that call the same implementation.
+*/
+inline std::vector<dispatch_trace_record> dispatch_trace_snapshot(){
+    dispatch_trace_registry& registry = dispatch_trace_registry::instance();
+    std::vector<dispatch_trace_record> records;
+    std::vector<std::pair<const dispatch_trace_method*,std::string>> names;
+    auto name_of = [&](const dispatch_trace_method* method) -> const std::string&{
+        for (auto& n : names)
+            if (n.first == method)
+                return n.second;
+        names.emplace_back(method,method->name());
+        return names.back().second;
+    };
+    int used = std::min(registry.used.load(std::memory_order_relaxed),dispatch_trace_registry::threads);
+    for (int k = 0; k < used; ++k){
+        dispatch_trace_ring& ring = registry.rings[k];
+        if (!ring.ready.load(std::memory_order_acquire))
+            continue;
+        std::uint64_t first = ring.next.load(std::memory_order_acquire);
+        struct raw{ const dispatch_trace_method* method; std::uint64_t timestamp; int cell; };
+        std::vector<raw> entries;
+        std::uint64_t begin = first > dispatch_trace_ring::capacity ? first-dispatch_trace_ring::capacity : 0;
+        for (std::uint64_t n = begin; n < first; ++n){
+            dispatch_trace_ring::entry& e = ring.entries[n & (dispatch_trace_ring::capacity-1)];
+            entries.push_back({e.method.load(std::memory_order_relaxed),e.timestamp.load(std::memory_order_relaxed),
+                               e.cell.load(std::memory_order_relaxed)});
+        }
+        // The entries started during the copy overwrote the oldest ones. If a copied entry was being
+        // overwritten, the fence makes its new start visible.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t last = ring.started.load(std::memory_order_relaxed);
+        std::uint64_t valid = last > dispatch_trace_ring::capacity ? last-dispatch_trace_ring::capacity : 0;
+        for (std::uint64_t n = std::max(begin,valid); n < first; ++n){
+            raw& r = entries[n-begin];
+            records.push_back({ring.owner.thread,r.timestamp,name_of(r.method),r.cell,r.method->cell_name(r.cell)});
+        }
+    }
+    std::stable_sort(records.begin(),records.end(),[](const dispatch_trace_record& a, const dispatch_trace_record& b){
+        return a.timestamp < b.timestamp;
+    });
+    return records;
+}
+
+inline void report_dispatch_trace(std::size_t count = 64, std::FILE* out = stderr){
+    std::vector<dispatch_trace_record> records = dispatch_trace_snapshot();
+    if (records.empty())
+        return;
+    double rate = dispatch_ticks_per_ns();
+    std::size_t first = records.size() > count ? records.size()-count : 0;
+    std::uint64_t end = records.back().timestamp;
+    std::vector<std::thread::id> threads;
+    for (std::size_t i = first; i < records.size(); ++i){
+        const dispatch_trace_record& r = records[i];
+        auto t = std::find(threads.begin(),threads.end(),r.thread);
+        if (t == threads.end())
+            t = threads.insert(threads.end(),r.thread);
+        std::fprintf(out,"%12.3f us  thread %d  %s  cell %d: %s\n",-((end-r.timestamp)/rate)/1000.0,static_cast<int>(t-threads.begin()),
+                     r.method.c_str(),r.cell,r.cell_signature.c_str());
+    }
+}
+
+#endif // OMM_TRACE
+
+
+//---------------------------------------------------------------------------------
+//-------------------------- Putting it all together  -----------------------------
+//---------------------------------------------------------------------------------
+
+template<typename T>
+struct Debug{};
+
+/**
+*   Checks whether the cells of an omm table cannot throw, i.e. every implementation it calls is noexcept.
+*   The calls to the table are noexcept if, besides, the cell is looked for without throwing (see
+*   nothrow_lookup) and the arguments are converted to the parameters without throwing.
+*    - T : The omm table.
+*/
+template<typename T>
+struct is_nothrow_omm : std::bool_constant<T::nothrow>{};
+
+template<typename T>
+static constexpr bool is_nothrow_omm_v = is_nothrow_omm<T>::value;
+
+/**
+*   The performance counters and the latency histograms register each method the first time it is
+*   called in a thread, which allocates memory, so the calls can throw std::bad_alloc with them.
+*/
+#if defined(OMM_PERF_COUNTERS) || defined(OMM_LATENCY_HISTOGRAMS)
+static constexpr bool nothrow_instrumentation = false;
+#else
+static constexpr bool nothrow_instrumentation = true;
+#endif
+
+/**
+*   Returns the option of an omm table wrapped by O, or D if there is none.
+*    - O : The wrapper of the option.
+*    - D : The default option.
+*    - OS... : The options passed to the omm table.
+*/
+template<typename P>
+struct policy_option{
+    using type = P;
+};
+
+template<typename S>
+struct strategy_option{
+    using type = S;
+};
+
+template<typename E>
+struct encoding_option{
+    using type = E;
+};
+
+template<template<typename> typename O, typename D, typename... OS>
+struct find_option{
+    using type = D;
+};
+
+template<template<typename> typename O, typename D, typename T, typename... OS>
+struct find_option<O,D,O<T>,OS...>{
+    using type = T;
+};
+
+template<template<typename> typename O, typename D, typename T, typename... OS>
+struct find_option<O,D,T,OS...> : find_option<O,D,OS...>{};
+
+template<template<typename> typename O, typename D, typename... OS>
+using find_option_t = typename find_option<O,D,OS...>::type;
+
 //---------------------------------------------------------------------------------
 
 /**
-*   Returns an index from the type_info of an object.
-*    - BM : A list whose first element is a base type and the rest are derived types.
-*    - info : The type_info of an object.
+*   Uses all the metafunctions defined above to create the omm table and allows to the
+*   user use open multi-methods.
+*    - F : The struct where the desired implementations are.
+*    - ftype : The function type indicating which are the virtual base types.
+*    - DCL : The derived types that participate in the multiple dispatch.
+*    - Options... : Optional settings of the table (see WithPolicy, WithStrategy and WithEncoding).
 */
-template<typename BM>
-struct position_derived_runtime_aux{
-    static int call(const std::type_info& info){
-        return 0;
+template<typename F, typename ftype, typename DCL, typename... Options>
+struct table_omm{
+
+    using POLICY                = find_option_t<policy_option,assume_valid,Options...>;
+    using VBS                   = ftype_to_sign_t<ftype>;
+    using BCL                   = get_base_core_types_t<VBS>;
+    using BS                    = vbsign_to_bsign_t<VBS>;
+    using CS                    = vbsign_to_csign_t<VBS>;
+    using TID                   = add_unknown_types_t<typename POLICY::checked,create_type_id_t<BCL,DCL>>;
+    using IND                   = make_indices_t<TID>;
+    using DCOMB                 = make_derived_combinations_t<TID,IND>;
+    using DSCOMB                = vbsign_to_dsign_combinations_t<VBS,DCOMB>;
+    using IMPL                  = exact_implementations_t<F,VBS,TID>;
+#ifdef OMM_PER_CELL_RESOLUTION
+    using KEYS                  = create_implementation_keys<F,IMPL,DSCOMB>;
+#else
+    using KEYS                  = scatter_implementation_keys<F,VBS,TID,DSCOMB>;
+#endif
+    using ENCODING              = find_option_t<encoding_option,pointer_encoding,Options...>;
+    static constexpr auto table = create_omm_table_v<F,CS,DSCOMB,IMPL,POLICY,KEYS>;
+    static constexpr const int* keys = &KEYS::value[0];
+    static constexpr int cells  = table_length_v<TID>;
+    using ENCODED               = encoded_table<ENCODING,create_omm_table<F,CS,DSCOMB,IMPL,POLICY,KEYS>,KEYS,cells,TID,VBS>;
+
+    static constexpr std::size_t table_bytes = ENCODED::bytes;
+    static constexpr int thunks              = count_thunks<cells>(keys,table,position_v<CS,IMPL>);
+    static constexpr bool nothrow            = create_omm_table_nothrow_v<F,CS,DSCOMB,IMPL,POLICY,KEYS>;
+
+    using STRATEGY              = select_strategy_t<find_option_t<strategy_option,automatic_strategy,Options...>,TID,KEYS>;
+    static constexpr dispatch_layout layout = {STRATEGY::name,ENCODING::name,length_v<TID>,cells,length_v<IMPL>,thunks,
+                                               static_cast<double>(length_v<IMPL>)/cells,table_bytes,
+                                               dispatch_cost<TID>::tree_levels(cells)*(std::is_same<ENCODING,lazy_encoding>::value ? sizeof(bool) : sizeof(table[0])),
+                                               dispatch_cost<TID>::table(),dispatch_cost<TID>::tree(keys,cells)};
+
+    static auto cell(int index) noexcept{
+        return ENCODED::at(index);
     }
-};
 
-template<typename D, typename S>
-struct position_derived_runtime_aux<cons<D,S>>{
-    static int call(const std::type_info& info){
-        if (info == typeid(D))
-            return 0;
-        else
-            return 1+position_derived_runtime_aux<S>::call(info);
+    // A call cannot throw if the lookup, the conversions of the arguments and the cell cannot throw.
+    template<typename... AS>
+    static constexpr bool nothrow_call = nothrow_lookup_v<VBS,AS&...> && cell_call<BS>::template nothrow<decltype(cell(0)),AS...>;
+
+    // The slots of the objects can be stored and used later to call the implementation (see call_cell).
+    static constexpr int dimensions = length_v<TID>;
+
+    template<int N>
+    static constexpr int slots = length_v<nth_t<TID,int_constant<N>>>;
 
+    template<int N, typename A>
+    static int slot(A&& a){
+        static_assert(N >= 0 && N < dimensions,"There is no virtual argument with that number");
+        return position_runtime<nth_t<TID,int_constant<N>>,A&>::call(a);
     }
-};
 
-template<typename BM>
-struct position_derived_runtime{
-    static int call(const std::type_info& info){
-        return position_derived_runtime_aux<BM>::call(info);
+    template<typename... SS>
+    static constexpr int cell_of_slots(SS... ss){
+        static_assert(sizeof...(SS) == dimensions,"There must be a slot per virtual argument");
+        return slots_index<TID>::call(static_cast<int>(ss)...);
+    }
+
+    template<typename... AS>
+    static int cell_of(AS&&... as){
+        return get_index<TID,VBS,AS&...>::call(as...);
+    }
+
+    // The cell is not looked for, so the performance counters see an empty lookup.
+    template<typename... AS>
+    static auto call_cell(int index, AS&&... as) noexcept(cell_call<BS>::template nothrow<decltype(cell(0)),AS...> && nothrow_instrumentation){
+        assert(index == cell_of(as...) && "omm: the cell does not match the arguments");
+#ifdef OMM_PERF_COUNTERS
+        dispatch_probe probe(method_perf_counters<F,BS>::local());
+        probe.lookup_done();
+#endif
+#ifdef OMM_TRACE
+        dispatch_trace(&method_trace<F,BS,DSCOMB>::method,index);
+#endif
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_attribution attribution(method_latency<F,BS,DSCOMB>::local()+index);
+#endif
+        return cell_call<BS>::call(cell(index),std::forward<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static auto call(AS&&... as) noexcept(nothrow_call<AS...> && nothrow_instrumentation){
+        return strategy_call<STRATEGY,table_omm>::call(std::forward<AS>(as)...);
+    }
+
+    // Called from an implementation with its own parameters, calls the next implementation without dispatching.
+    template<typename... AS>
+    static auto call_next(AS&&... as)
+        noexcept(next_implementation_call<F,tlist_to_collection_t<typename next_implementation<F,TID,VBS,DSCOMB,AS...>::type>>::template nothrow<AS...>){
+        using NEXT = next_implementation_call<F,tlist_to_collection_t<typename next_implementation<F,TID,VBS,DSCOMB,AS...>::type>>;
+        return NEXT::call(std::forward<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static auto table_call(AS&&... as) noexcept(nothrow_call<AS...> && nothrow_instrumentation){
+#ifdef OMM_PERF_COUNTERS
+        dispatch_probe probe(method_perf_counters<F,BS>::local());
+#endif
+        int index = get_index<TID,VBS,AS&...>::call(as...);
+#ifdef OMM_PERF_COUNTERS
+        probe.lookup_done();
+#endif
+#ifdef OMM_TRACE
+        dispatch_trace(&method_trace<F,BS,DSCOMB>::method,index);
+#endif
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_attribution attribution(method_latency<F,BS,DSCOMB>::local()+index);
+#endif
+        return cell_call<BS>::call(cell(index),std::forward<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static auto tree_call(AS&&... as) noexcept(nothrow_call<AS...> && nothrow_instrumentation){
+#ifdef OMM_PERF_COUNTERS
+        dispatch_probe probe(method_perf_counters<F,BS>::local());
+#endif
+        int index;
+        auto function = tree_lookup<table_omm,AS&...>::call(index,as...);
+#ifdef OMM_PERF_COUNTERS
+        probe.lookup_done();
+#endif
+#ifdef OMM_TRACE
+        dispatch_trace(&method_trace<F,BS,DSCOMB>::method,index);
+#endif
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_attribution attribution(method_latency<F,BS,DSCOMB>::local()+index);
+#endif
+        return cell_call<BS>::call(function,std::forward<AS>(as)...);
     }
 };
 
+
+//---------------------------------------------------------------------------------
+//------------------------------- Symmetric methods -------------------------------
 //---------------------------------------------------------------------------------
 
 /**
-*   Returns the type_info of the most derived type of an object.
-*    - A : The type of the object the type_info will be created from.
-*    - a : The object to retrieve its type_info.
+*   Returns a list with the positions of the virtual parameters of a signature, without counting the
+*   return type.
+*    - VBS : The VBS type without the return type.
+*    - N : The position of the first parameter of VBS.
 */
-template<typename IsPtr, typename A>
-struct get_type_id_aux{
-    static const std::type_info& call(A&& a){
-        return typeid(a);
-    }
+template<typename VBS, typename N = zero>
+struct virtual_positions : nil{};
+
+template<typename B, typename BS, typename N>
+struct virtual_positions<cons<B,BS>,N> : virtual_positions<BS,add1_t<N>>{};
+
+template<typename B, typename BS, typename N>
+struct virtual_positions<cons<virtual_type<B>,BS>,N> : cons<N,typename virtual_positions<BS,add1_t<N>>::type>{};
+
+template<typename VBS>
+using virtual_positions_t = typename virtual_positions<VBS>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The positions of the two virtual arguments of a symmetric method, which are swapped by the
+*   mirrored implementations.
+*    - P : The position of the first virtual argument.
+*    - Q : The position of the second virtual argument.
+*/
+template<int P, int Q>
+struct swapped_arguments{
+    template<std::size_t I>
+    static constexpr std::size_t position = I == P ? Q : (I == Q ? P : I);
 };
 
-template<typename A>
-struct get_type_id_aux<std::true_type,A>{
-    static const std::type_info& call(A&& a){
-        return typeid(*a);
+//---------------------------------------------------------------------------------
+
+/**
+*   Swaps the two virtual parameters of a signature.
+*    - S : The signature.
+*    - SW : The swapped_arguments.
+*/
+template<typename C, typename SW, typename IS>
+struct mirror_signature_aux{};
+
+template<typename R, typename... Args, typename SW, std::size_t... IS>
+struct mirror_signature_aux<collection<R,Args...>,SW,std::index_sequence<IS...>>
+    : tlist<R,std::tuple_element_t<SW::template position<IS>,std::tuple<Args...>>...>{};
+
+template<typename S, typename SW>
+struct mirror_signature : mirror_signature_aux<tlist_to_collection_t<S>,SW,std::make_index_sequence<length_v<S>-1>>{};
+
+template<typename S, typename SW>
+using mirror_signature_t = typename mirror_signature<S,SW>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Generates a function pointer that calls the implementation with the signature S with its two virtual
+*   arguments swapped, so a cell (i,j) can call an implementation written for (j,i).
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - S : The signature of the implementation.
+*    - SW : The swapped_arguments.
+*/
+template<typename HasImplementation, typename F, typename BC, typename SC, typename SW, typename IS>
+struct mirrored_function_cell_aux{
+    static constexpr std::nullptr_t value = nullptr;
+};
+
+template<typename F, typename R, typename... Bargs, typename... Sargs, typename SW, std::size_t... IS>
+struct mirrored_function_cell_aux<std::true_type,F,collection<R,Bargs...>,collection<R,Sargs...>,SW,std::index_sequence<IS...>>{
+    static constexpr bool nothrow = noexcept(F::implementation(argument_cast<Sargs,Bargs>::call(std::declval<Bargs>())...)) &&
+                                    nothrow_cell_instrumentation;
+    static R function(Bargs... args) noexcept(nothrow){
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_timer<implementation_latency<F,collection<R,Bargs...>,collection<R,Sargs...>>> timer;
+#endif
+        std::tuple<Bargs&&...> refs(std::forward<Bargs>(args)...);
+        return F::implementation(argument_cast<Sargs,Bargs>::call(std::get<SW::template position<IS>>(std::move(refs)))...);
     }
+    static constexpr std::add_pointer_t<R(Bargs...) noexcept(nothrow)> value = &function;
 };
 
-template<typename A>
-struct get_type_id{
-    static const std::type_info& call(A&& a){
-        return get_type_id_aux<std::is_pointer_t<std::remove_reference_t<A>>,A>::call(std::forward<A>(a));
+template<typename F, typename BS, typename S, typename SW>
+struct mirrored_function_cell : mirrored_function_cell_aux<has_implementation_t<F,tlist_to_collection_t<S>>,F,tlist_to_collection_t<BS>,
+                                                           tlist_to_collection_t<S>,SW,std::make_index_sequence<length_v<BS>-1>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Computes the keys of a symmetric method. Its omm table only has the cells (i,j) with i <= j, the cell (i,j)
+*   being at j*(j+1)/2 + i. Every implementation is placed in the cells it accepts, and its mirror (the same
+*   implementation with the virtual arguments swapped) too. Then, each cell takes the most specific of them
+*   like in implementation_scatter. An implementation is not ambiguous with its mirror, and if two of them are
+*   as specific as each other, the one that does not swap the arguments is taken.
+*   The choice of a cell is 2k if it calls the k-th implementation of IMPL, 2k+1 if it calls its mirror, -1
+*   if the overload resolution is done for that cell and -2 for the cells with unknown_type. The keys number
+*   the choices in order of appearance, so the cells with the same key share the function.
+*    - Cells : The number of cells of the whole omm table.
+*    - A : The type_id_arrays of the TID type, with two equal lists.
+*/
+template<int Cells, typename A>
+struct symmetric_scatter : implementation_scatter<Cells,A>{
+
+    using base = implementation_scatter<Cells,A>;
+
+    static constexpr int n = A::lengths[0];
+    static constexpr int half = n*(n+1)/2;
+
+    static constexpr int mirror(int c){
+        return (c % n)*n + c/n;
+    }
+
+    // The cells of the whole omm table, in the order of the symmetric one.
+    static constexpr std::array<int,half> whole_cells(){
+        std::array<int,half> cells{};
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i <= j; ++i)
+                cells[j*(j+1)/2 + i] = i*n + j;
+        return cells;
+    }
+
+    static constexpr int placed(const std::array<int,Cells>& implementations, int choice){
+        return choice % 2 == 0 ? implementations[choice/2] : mirror(implementations[choice/2]);
+    }
+
+    static constexpr int most_specific(const std::array<int,Cells>& implementations, int count, int c){
+        int best = -1;
+        for (int k = 0; k < 2*count; ++k){
+            if (!base::accepts(placed(implementations,k),c))
+                continue;
+            bool covers = best < 0 || base::accepts(placed(implementations,best),placed(implementations,k));
+            bool covered = best >= 0 && base::accepts(placed(implementations,k),placed(implementations,best));
+            if (covers && (!covered || (k % 2 == 0 && best % 2 == 1)))
+                best = k;
+        }
+        for (int k = 0; k < 2*count && best >= 0; ++k)
+            if (k/2 != best/2 && base::accepts(placed(implementations,k),c)
+                              && !base::accepts(placed(implementations,k),placed(implementations,best)))
+                best = -1;
+        return best;
+    }
+
+    static constexpr std::array<int,half> choices(const bool* exact){
+        std::array<int,Cells> implementations{};
+        int count = base::list_implementations(exact,implementations);
+
+        std::array<int,half> choice{};
+        std::array<int,half> cells = whole_cells();
+        for (int h = 0; h < half; ++h)
+            choice[h] = base::is_unknown(cells[h]) ? -2 : most_specific(implementations,count,cells[h]);
+        return choice;
+    }
+
+    static constexpr std::array<int,half> keys(const std::array<int,half>& choice){
+        std::array<int,half> keys{};
+        int count = 0;
+        for (int h = 0; h < half; ++h){
+            keys[h] = choice[h];
+            if (choice[h] < 0)
+                continue;
+            keys[h] = count;
+            for (int g = 0; g < h; ++g)
+                if (choice[g] == choice[h])
+                    keys[h] = keys[g];
+            count += keys[h] == count ? 1 : 0;
+        }
+        return keys;
     }
+
+    // The key of the cells storing the implementation k directly, or -1.
+    static constexpr int key_of(const std::array<int,half>& choice, const std::array<int,half>& keys, int k){
+        for (int h = 0; h < half; ++h)
+            if (k >= 0 && choice[h] == 2*k)
+                return keys[h];
+        return -1;
+    }
+};
+
+/**
+*   Checks the choices of symmetric_scatter like scattered_keys_selected does with the keys. The choice of a
+*   mirror is checked against the overload resolution of the mirrored cell.
+*    - IsChecked : A bool_constant indicating whether F may have overloads that are not in IMPL.
+*    - F : The struct containing all the implementations.
+*    - IMPL : The IMPL type.
+*    - SC : The type holding the scatter, the choices and the cells of the symmetric keys.
+*    - DSC : The DSCOMB type as a collection.
+*/
+template<typename IsChecked, typename F, typename IMPL, typename SC, typename DSC, typename IS>
+struct symmetric_choices_selected{
+    static constexpr const bool* value = nullptr;
+};
+
+template<typename F, typename IMPL, typename SC, typename... DS, std::size_t... IS>
+struct symmetric_choices_selected<std::true_type,F,IMPL,SC,collection<DS...>,std::index_sequence<IS...>>{
+    template<std::size_t H>
+    using signature = std::tuple_element_t<SC::choice[H] % 2 == 0 ? SC::cells[H] : SC::scatter::mirror(SC::cells[H]),std::tuple<DS...>>;
+
+    static constexpr bool value[] = {scattered_key_selected<std::bool_constant<(SC::choice[IS] >= 0)>,F,IMPL,signature<IS>,SC::choice[IS]/2>::value...};
+};
+
+template<typename F, typename VBS, typename TID, typename DSCOMB, typename IMPL>
+struct symmetric_implementation_keys_aux{};
+
+template<typename F, typename VBS, typename TID, typename... DS, typename IMPL>
+struct symmetric_implementation_keys_aux<F,VBS,TID,collection<DS...>,IMPL>{
+    struct scattered{
+        using scatter = symmetric_scatter<sizeof...(DS),type_id_arrays<TID>>;
+        static constexpr auto choice = scatter::choices(scattered_keys<F,VBS,TID,sizeof...(DS)>::exact.data());
+        static constexpr auto cells = scatter::whole_cells();
+    };
+    using scatter = typename scattered::scatter;
+    static constexpr bool checked = has_foreign_overloads<F,VBS,TID>::value;
+    static constexpr auto selected = symmetric_choices_selected<std::bool_constant<checked>,F,IMPL,scattered,collection<DS...>,
+                                                                std::make_index_sequence<scatter::half>>::value;
+    static constexpr auto choice = checked_scattered_keys<scatter::half>(scattered::choice,selected);
+    static constexpr auto value = scatter::keys(choice);
+    static constexpr auto cells = scattered::cells;
+};
+
+template<typename F, typename VBS, typename TID, typename DSCOMB>
+struct symmetric_implementation_keys : symmetric_implementation_keys_aux<F,VBS,TID,tlist_to_collection_t<DSCOMB>,exact_implementations_t<F,VBS,TID>>{};
+
+/**
+*   The signatures of the cells of a symmetric omm table, in its order, so the trace and the latency
+*   histograms can name its cells.
+*    - DSCOMB : The DSCOMB type.
+*    - K : The symmetric_implementation_keys.
+*/
+template<typename DSC, typename K, typename IS>
+struct symmetric_cell_signatures_aux{};
+
+template<typename... DS, typename K, std::size_t... IS>
+struct symmetric_cell_signatures_aux<collection<DS...>,K,std::index_sequence<IS...>>
+    : tlist<std::tuple_element_t<K::cells[IS],std::tuple<DS...>>...>{};
+
+template<typename DSCOMB, typename K>
+struct symmetric_cell_signatures : symmetric_cell_signatures_aux<tlist_to_collection_t<DSCOMB>,K,std::make_index_sequence<K::scatter::half>>{};
+
+template<typename DSCOMB, typename K>
+using symmetric_cell_signatures_t = typename symmetric_cell_signatures<DSCOMB,K>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the function pointer stored in a cell of the symmetric omm table, from its choice (see
+*   symmetric_scatter). If the overload resolution is done for the cell, the mirrored signature is tried
+*   when the signature of the cell has no implementation.
+*    - Choice : The choice of the cell.
+*    - P : The policy.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DS : The signature of the cell.
+*    - IMPL : The IMPL type.
+*    - SW : The swapped_arguments.
+*/
+template<typename IsDirect, typename Choice, typename P, typename F, typename BS, typename DS, typename IMPL, typename SW>
+struct symmetric_function_cell_aux : policy_function_cell<int_constant<Choice::value/2>,P,F,BS,DS,IMPL>{};
+
+template<typename Choice, typename P, typename F, typename BS, typename DS, typename IMPL, typename SW>
+struct symmetric_function_cell_aux<std::false_type,Choice,P,F,BS,DS,IMPL,SW> : mirrored_function_cell<F,BS,nth_t<IMPL,int_constant<Choice::value/2>>,SW>{};
+
+template<typename Choice, typename P, typename F, typename BS, typename DS, typename IMPL, typename SW>
+struct symmetric_function_cell : symmetric_function_cell_aux<std::bool_constant<Choice::value % 2 == 0>,Choice,P,F,BS,DS,IMPL,SW>{};
+
+template<typename P, typename F, typename BS, typename DS, typename IMPL, typename SW>
+struct symmetric_function_cell<int_constant<-2>,P,F,BS,DS,IMPL,SW> : policy_function_cell<int_constant<-2>,P,F,BS,DS,IMPL>{};
+
+template<typename P, typename F, typename BS, typename DS, typename IMPL, typename SW>
+struct symmetric_function_cell<int_constant<-1>,P,F,BS,DS,IMPL,SW>
+    : std::conditional_t<!has_implementation_v<F,tlist_to_collection_t<DS>> && has_implementation_v<F,tlist_to_collection_t<mirror_signature_t<DS,SW>>>,
+                         mirrored_function_cell<F,BS,mirror_signature_t<DS,SW>,SW>,
+                         policy_function_cell<int_constant<-1>,P,F,BS,DS,IMPL>>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Creates the symmetric omm table. If no cell can throw, the function pointers are noexcept.
+*    - F : The struct containing all the implementations.
+*    - BS : The CS type (see vbsign_to_csign).
+*    - DSCOMB : The DSCOMB type.
+*    - IMPL : The IMPL type.
+*    - P : The policy.
+*    - K : The symmetric_implementation_keys.
+*    - SW : The swapped_arguments.
+*/
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K, typename SW, typename IS>
+struct create_symmetric_table_aux{};
+
+template<typename F, typename BS, typename... DS, typename IMPL, typename P, typename K, typename SW, std::size_t... IS>
+struct create_symmetric_table_aux<F,BS,collection<DS...>,IMPL,P,K,SW,std::index_sequence<IS...>>{
+    template<std::size_t I>
+    using cell = symmetric_function_cell<int_constant<K::choice[I]>,P,F,BS,std::tuple_element_t<K::cells[I],std::tuple<DS...>>,IMPL,SW>;
+
+    static constexpr bool nothrow = (is_nothrow_cell_v<decltype(cell<IS>::value)> && ...);
+    using function_type = std::conditional_t<nothrow,add_noexcept_t<signature_to_function_type_t<BS>>,signature_to_function_type_t<BS>>;
+    static constexpr std::add_pointer_t<function_type> value[] = {cell<IS>::value...};
 };
 
+template<typename F, typename BS, typename DSCOMB, typename IMPL, typename P, typename K, typename SW>
+struct create_symmetric_table : create_symmetric_table_aux<F,BS,tlist_to_collection_t<DSCOMB>,IMPL,P,K,SW,
+                                                           std::make_index_sequence<std::tuple_size<decltype(K::value)>::value>>{};
+
 //---------------------------------------------------------------------------------
 
 /**
-*   Returns the index where the implementation that must be called is.
-*    - TID : The TID type.
-*    - VBS : The VBS type.
-*    - AS... : The types of the arguments that will be passed to the implementation.
-*    - as... : The objects that will be passed to the implementation.
+*   Holds the two virtual arguments of a call to a symmetric method, so they can be passed in any order.
+*   References are stored as pointers, and the rest of arguments (pointers, enums...) by value.
+*    - B : The type of the virtual parameters in the BS type.
 */
-template<typename Tid, typename VBS, typename... AS>
-struct get_index_aux{
-    static constexpr int current_multiplier = 1;
-    static int call(AS&&... as){
-        return 0;
+template<typename B>
+struct symmetric_pair{
+
+    std::remove_reference_t<B>* values[2];
+
+    symmetric_pair(B a, B b) noexcept : values{std::addressof(a),std::addressof(b)}{}
+
+    std::remove_reference_t<B>& at(int i) noexcept{
+        return *values[i];
+    }
+
+    B get(int i) noexcept{
+        return static_cast<B>(*(i ? values[1] : values[0]));
     }
 };
 
-template<typename Tid, typename B, typename BS, typename A, typename... AS>
-struct get_index_aux<Tid,cons<B,BS>,A,AS...>{
-    static constexpr int current_multiplier = get_index_aux<Tid,BS,AS...>::current_multiplier;
-    static int call(A&& a, AS&&... as){
-        return get_index_aux<Tid,BS,AS...>::call(std::forward<AS>(as)...);
+template<typename B>
+struct symmetric_pair_values{
+
+    B values[2];
+
+    symmetric_pair_values(B a, B b) noexcept : values{a,b}{}
+
+    B& at(int i) noexcept{
+        return values[i];
+    }
+
+    B get(int i) noexcept{
+        return values[i];
     }
 };
 
-template<typename T, typename TS, typename B, typename BS, typename A, typename... AS>
-struct get_index_aux<cons<T,TS>,cons<virtual_type<B>,BS>,A,AS...>{
-    static constexpr int current_multiplier = get_index_aux<TS,BS,AS...>::current_multiplier*length_v<T>;
-    static int call(A&& a, AS&&... as){
-        return get_index_aux<TS,BS,AS...>::call(std::forward<AS>(as)...)
-               + position_derived_runtime<T>::call(get_type_id<A>::call(std::forward<A>(a)))*get_index_aux<TS,BS,AS...>::current_multiplier;
+/**
+*   Returns the argument at a position of the call to the cell. It is the argument received by the call,
+*   except for the virtual arguments, which are taken from the pair in the order of the cell.
+*    - Which : 1 for the first virtual argument, 2 for the second one and 0 for the rest of arguments.
+*/
+template<int Which>
+struct symmetric_argument{
+    template<typename Pair, typename A>
+    static A&& get(Pair&, int, A&& a) noexcept{
+        return std::forward<A>(a);
     }
 };
 
-template<typename Tid, typename VBS, typename... AS>
-struct get_index{
-    static int call(AS&&... as){
-        return get_index_aux<Tid,cdr_t<VBS>,AS...>::call(std::forward<AS>(as)...);
+template<>
+struct symmetric_argument<1>{
+    template<typename Pair, typename A>
+    static auto get(Pair& pair, int swap, A&&) noexcept -> decltype(pair.get(swap)){
+        return pair.get(swap);
     }
 };
 
+template<>
+struct symmetric_argument<2>{
+    template<typename Pair, typename A>
+    static auto get(Pair& pair, int swap, A&&) noexcept -> decltype(pair.get(swap)){
+        return pair.get(1-swap);
+    }
+};
 
-//---------------------------------------------------------------------------------
-//-------------------------- Putting it all together  -----------------------------
 //---------------------------------------------------------------------------------
 
-template<typename T>
-struct Debug{};
+/**
+*   Dispatches a call to a symmetric method. Both virtual arguments are identified, and the one with the
+*   smallest position in its list goes first, so the cell (i,j) with i <= j is called. The order is chosen
+*   without branches: swap is 0 or 1 and selects the arguments from the pair.
+*    - T : The symmetric omm table.
+*    - P : The position of the first virtual argument.
+*    - Q : The position of the second virtual argument.
+*    - AS... : The types of the arguments.
+*/
+template<typename T, int P, int Q, typename... AS>
+struct symmetric_dispatch{
+
+    using B = nth_t<typename T::BS,int_constant<P+1>>;
+    using R = car_t<typename T::TID>;
+    using pair_type = std::conditional_t<std::is_reference<B>::value,symmetric_pair<B>,symmetric_pair_values<B>>;
+
+    static int index(pair_type& pair, int& swap){
+        int s0 = position_runtime<R,std::remove_reference_t<B>&>::call(pair.at(0));
+        int s1 = position_runtime<R,std::remove_reference_t<B>&>::call(pair.at(1));
+        swap = s0 > s1;
+        unsigned mask = -static_cast<unsigned>(swap);
+        unsigned lo = s0 ^ ((s0 ^ s1) & mask);
+        unsigned hi = s1 ^ ((s0 ^ s1) & mask);
+        return static_cast<int>(hi*(hi+1)/2 + lo);
+    }
+
+    static pair_type pair_of(AS&&... as){
+        std::tuple<AS&&...> refs(std::forward<AS>(as)...);
+        return pair_type(std::get<P>(std::move(refs)),std::get<Q>(std::move(refs)));
+    }
+
+    // Calls the function of the cell, with the virtual arguments in the order of the cell.
+    template<typename Function, std::size_t... IS>
+    static auto call(std::index_sequence<IS...>, Function f, pair_type& pair, int swap, AS&&... as) noexcept(T::template nothrow_call<AS...>){
+        return cell_call<typename T::BS>::call(f,symmetric_argument<IS == P ? 1 : (IS == Q ? 2 : 0)>::get(pair,swap,std::forward<AS>(as))...);
+    }
+
+    static int cell_of(AS&&... as){
+        pair_type pair = pair_of(std::forward<AS>(as)...);
+        int swap = 0;
+        return index(pair,swap);
+    }
+};
+
+//---------------------------------------------------------------------------------
 
 /**
-*   Uses all the metafunctions defined above to create the omm table and allows to the
-*   user use open multi-methods.
+*   The omm table of a symmetric method, i.e. a method with two virtual arguments of the same type whose
+*   result does not depend on their order. Only the implementations for one order of the types are needed:
+*   the mirrored ones are derived from them. The table only has the cells (i,j) with i <= j, which is almost
+*   half of the cells of table_omm, and the calls swap the virtual arguments when needed.
+*   The calls always use the table strategy.
 *    - F : The struct where the desired implementations are.
 *    - ftype : The function type indicating which are the virtual base types.
 *    - DCL : The derived types that participate in the multiple dispatch.
+*    - Options... : Optional settings of the table (see WithPolicy and WithEncoding).
 */
-template<typename F, typename ftype, typename DCL>
-struct table_omm{
+template<typename F, typename ftype, typename DCL, typename... Options>
+struct symmetric_table_omm{
 
+    using POLICY                = find_option_t<policy_option,assume_valid,Options...>;
     using VBS                   = ftype_to_sign_t<ftype>;
     using BCL                   = get_base_core_types_t<VBS>;
     using BS                    = vbsign_to_bsign_t<VBS>;
-    using TID                   = create_type_id_t<BCL,DCL>;
+    using CS                    = vbsign_to_csign_t<VBS>;
+    using TID                   = add_unknown_types_t<typename POLICY::checked,create_type_id_t<BCL,DCL>>;
+
+    static_assert(length_v<TID> == 2,"A symmetric method must have two virtual arguments");
+    static constexpr int P      = nth_t<virtual_positions_t<cdr_t<VBS>>,zero>::value;
+    static constexpr int Q      = nth_t<virtual_positions_t<cdr_t<VBS>>,one>::value;
+    static_assert(std::is_same<nth_t<BS,int_constant<P+1>>,nth_t<BS,int_constant<Q+1>>>::value,
+                  "The virtual arguments of a symmetric method must have the same type");
+    using SWAP                  = swapped_arguments<P,Q>;
+
     using IND                   = make_indices_t<TID>;
     using DCOMB                 = make_derived_combinations_t<TID,IND>;
     using DSCOMB                = vbsign_to_dsign_combinations_t<VBS,DCOMB>;
-    static constexpr auto table = create_omm_table_v<F,BS,DSCOMB>;
+    using IMPL                  = exact_implementations_t<F,VBS,TID>;
+    using KEYS                  = symmetric_implementation_keys<F,VBS,TID,DSCOMB>;
+    using ENCODING              = find_option_t<encoding_option,pointer_encoding,Options...>;
+    using TABLE                 = create_symmetric_table<F,CS,DSCOMB,IMPL,POLICY,KEYS,SWAP>;
+    static constexpr auto table = TABLE::value;
+    static constexpr const int* keys = &KEYS::value[0];
+    static constexpr int cells  = KEYS::scatter::half;
+    static_assert(!std::is_same<ENCODING,lazy_encoding>::value,"omm: lazy_encoding is only available for table_omm");
+    using ENCODED               = encoded_table<ENCODING,TABLE,KEYS,cells>;
+
+    static constexpr std::size_t table_bytes = ENCODED::bytes;
+    static constexpr int thunks              = count_thunks<cells>(keys,table,KEYS::scatter::key_of(KEYS::choice,KEYS::value,position_v<CS,IMPL>));
+    static constexpr bool nothrow            = TABLE::nothrow;
+
+    using STRATEGY              = table_strategy;
+    static constexpr dispatch_layout layout = {"symmetric table",ENCODING::name,2,cells,length_v<IMPL>,thunks,
+                                               static_cast<double>(length_v<IMPL>)/cells,table_bytes,0,
+                                               dispatch_cost<TID>::table(),dispatch_cost<TID>::table()};
+
+    static auto cell(int index) noexcept{
+        return ENCODED::at(index);
+    }
 
+    // A call cannot throw if the lookup, the conversions of the arguments and the cell cannot throw.
     template<typename... AS>
-    static auto call(AS&&... as){
-        return table[get_index<TID,VBS,AS...>::call(std::forward<AS>(as)...)](std::forward<AS>(as)...);
+    static constexpr bool nothrow_call = nothrow_lookup_v<VBS,AS&...> && cell_call<BS>::template nothrow<decltype(cell(0)),AS...>;
+
+    // Both virtual arguments have the same slots. The cell does not depend on their order.
+    static constexpr int dimensions = 2;
+
+    template<int N>
+    static constexpr int slots = length_v<car_t<TID>>;
+
+    template<int N, typename A>
+    static int slot(A&& a){
+        static_assert(N >= 0 && N < dimensions,"There is no virtual argument with that number");
+        return position_runtime<car_t<TID>,A&>::call(a);
+    }
+
+    static constexpr int cell_of_slots(int s0, int s1){
+        return s0 > s1 ? s0*(s0+1)/2 + s1 : s1*(s1+1)/2 + s0;
+    }
+
+    template<typename... AS>
+    static int cell_of(AS&&... as){
+        return symmetric_dispatch<symmetric_table_omm,P,Q,AS&...>::cell_of(as...);
+    }
+
+    template<typename... AS>
+    static auto call(AS&&... as) noexcept(nothrow_call<AS...> && nothrow_instrumentation){
+        return table_call(std::forward<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static auto table_call(AS&&... as) noexcept(nothrow_call<AS...> && nothrow_instrumentation){
+        using DISPATCH = symmetric_dispatch<symmetric_table_omm,P,Q,AS...>;
+#ifdef OMM_PERF_COUNTERS
+        dispatch_probe probe(method_perf_counters<F,BS>::local());
+#endif
+        auto pair = DISPATCH::pair_of(std::forward<AS>(as)...);
+        int swap = 0;
+        int index = DISPATCH::index(pair,swap);
+        auto function = cell(index);
+#ifdef OMM_PERF_COUNTERS
+        probe.lookup_done();
+#endif
+#ifdef OMM_TRACE
+        dispatch_trace(&method_trace<F,BS,symmetric_cell_signatures_t<DSCOMB,KEYS>>::method,index);
+#endif
+#ifdef OMM_LATENCY_HISTOGRAMS
+        latency_attribution attribution(method_latency<F,BS,symmetric_cell_signatures_t<DSCOMB,KEYS>>::local()+index);
+#endif
+        return DISPATCH::call(std::index_sequence_for<AS...>{},function,pair,swap,std::forward<AS>(as)...);
     }
 };
 
 
+//---------------------------------------------------------------------------------
+
+/**
+*   Checks whether an omm table belongs to a symmetric method (see symmetric_table_omm).
+*    - T : The omm table.
+*/
+template<typename T>
+struct is_symmetric_omm : std::false_type{};
+
+template<typename F, typename ftype, typename DCL, typename... Options>
+struct is_symmetric_omm<symmetric_table_omm<F,ftype,DCL,Options...>> : std::true_type{};
+
+template<typename T>
+static constexpr bool is_symmetric_omm_v = is_symmetric_omm<T>::value;
+
+
 //---------------------------------------------------------------------------------
 //------------------------------- User interface  ---------------------------------
 //---------------------------------------------------------------------------------
@@ -1171,7 +5432,20 @@ using WithSignature = F;
 *   Used to indicate the types that participate in the multiple dispatch.
 */
 template<typename T>
-using Virtual = std::enable_if_t<is_polymorphic_pr_v<T>,virtual_type<T>>;
+using Virtual = std::enable_if_t<is_polymorphic_pr_v<T> || is_enum_value_v<T>,virtual_type<T>>;
+
+/**
+*   Used to indicate the values of an enum (or an integral type) that participate in the multiple
+*   dispatch. It must be wrapped by Virtual.
+*/
+template<typename E, E... VS>
+using EnumValue = enum_value<E,VS...>;
+
+/**
+*   Helper to write the parameter of an implementation that receives a specific value.
+*/
+template<auto V>
+using Value = std::integral_constant<decltype(V),V>;
 
 /**
 *   Helper to create a list with the derived types that will participate on the
@@ -1180,6 +5454,27 @@ using Virtual = std::enable_if_t<is_polymorphic_pr_v<T>,virtual_type<T>>;
 template<typename... DS>
 using WithDerivedTypes = tlist_t<DS...>;
 
+/**
+*   Used to indicate what to do with invalid calls (see the dispatch policies). By default, the calls
+*   are assumed to be valid.
+*/
+template<typename P>
+using WithPolicy = policy_option<P>;
+
+/**
+*   Used to choose how the implementation to call is found (see the dispatch strategies). By default,
+*   the strategy is chosen automatically.
+*/
+template<typename S>
+using WithStrategy = strategy_option<S>;
+
+/**
+*   Used to choose how the omm table is stored (see the table encodings). By default, it is an array
+*   of function pointers.
+*/
+template<typename E>
+using WithEncoding = encoding_option<E>;
+
 
 
 
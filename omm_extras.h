@@ -0,0 +1,1172 @@
+#ifndef OMM_EXTRAS_H_INCLUDED
+#define OMM_EXTRAS_H_INCLUDED
+
+#include "omm.h"
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+/**
+ The parts of omm that need more headers of the standard library: the std::any adapter, the segmented
+ collection and all_pairs, which need std::vector, the parallel reduction and the dispatch queues, which
+ need the thread support. They are not in omm.h, so the translation units that only create and call omm
+ tables do not parse those headers.
+*/
+
+
+//---------------------------------------------------------------------------------
+//------------------------------------ std::any -----------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Lets a std::any be a virtual type (see is_erased_adapter). The types it can contain are the copy
+*   constructible types of the DCL.
+*/
+template<>
+struct virtual_adapter<std::any> : std::true_type{
+
+    using pointee = std::any;
+
+    template<typename D>
+    using holds = std::is_copy_constructible<D>;
+
+    static const std::type_info& type_id(const std::any& a) noexcept{
+        return a.type();
+    }
+
+    template<typename D>
+    static const D* get(const std::any& a) noexcept{
+        return std::any_cast<D>(&a);
+    }
+
+    template<typename D>
+    static D* get(std::any& a) noexcept{
+        return std::any_cast<D>(&a);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//---------------------------- Segmented collection -------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Turns an element of a segment into the argument expected by the omm table.
+*    - A : The type of the parameter in the BS type.
+*    - D : The type of the element.
+*/
+template<typename IsPtr, typename D>
+struct element_to_argument_aux{
+    static D& call(D& d){
+        return d;
+    }
+};
+
+template<typename D>
+struct element_to_argument_aux<std::true_type,D>{
+    static D* call(D& d){
+        return &d;
+    }
+};
+
+template<typename A, typename D>
+struct element_to_argument : element_to_argument_aux<std::is_pointer_t<A>,D>{};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Passes an argument of dispatch to each call of the method. The arguments received by reference keep
+*   their value category, and the ones received by value are copied in each call, so no call receives a
+*   moved-from object.
+*    - IsReference : A bool_constant indicating whether the parameter in the BS type is a reference.
+*    - A : The type of the argument, as received by dispatch.
+*/
+template<typename IsReference>
+struct repeated_argument{
+    template<typename A>
+    static std::remove_reference_t<A>& get(std::remove_reference_t<A>& a) noexcept{
+        return a;
+    }
+};
+
+template<>
+struct repeated_argument<std::true_type>{
+    template<typename A>
+    static A&& get(std::remove_reference_t<A>& a) noexcept{
+        return static_cast<A&&>(a);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls the method once per element of a segment. The cell of the omm table is known in compile
+*   time, so no type is identified. The cell is read once with T::cell, so every encoding can be used.
+*   If the type of the segment does not participate in the method, nothing is done.
+*    - IsDispatched : A bool_constant indicating whether the type of the segment participates in the method.
+*    - T : The omm table.
+*    - D : The type of the elements in the segment.
+*/
+template<typename IsDispatched, typename T, typename D>
+struct segment_dispatch{
+    template<typename... AS>
+    static void call(std::vector<D>&, AS&&...){}
+};
+
+template<typename T, typename D>
+struct segment_dispatch<std::true_type,T,D>{
+
+    template<std::size_t... IS, typename... AS>
+    static void call_each(std::vector<D>& segment, std::index_sequence<IS...>, AS&&... as){
+        auto f = T::cell(T::cell_of_slots(position_v<D,car_t<typename T::TID>>));
+        for (D& d : segment)
+            cell_call<typename T::BS>::call(f,element_to_argument<nth_t<typename T::BS,one>,D>::call(d),
+                                            repeated_argument<std::is_reference_t<nth_t<typename T::BS,int_constant<IS+2>>>>::template get<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static void call(std::vector<D>& segment, AS&&... as){
+        call_each(segment,std::index_sequence_for<AS...>{},std::forward<AS>(as)...);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls the function of a cell with a pair of elements. For symmetric methods, the cells whose first
+*   slot is greater expect the elements swapped (see symmetric_dispatch).
+*    - Swap : Whether the elements are swapped.
+*/
+template<bool Swap>
+struct segment_pair_cell_call{
+    template<typename BS, typename Function, typename D, typename E, typename... AS>
+    static void call(Function f, D& d, E& e, AS&&... as){
+        cell_call<BS>::call(f,element_to_argument<nth_t<BS,one>,D>::call(d),
+                            element_to_argument<nth_t<BS,int_constant<2>>,E>::call(e),std::forward<AS>(as)...);
+    }
+};
+
+template<>
+struct segment_pair_cell_call<true>{
+    template<typename BS, typename Function, typename D, typename E, typename... AS>
+    static void call(Function f, D& d, E& e, AS&&... as){
+        cell_call<BS>::call(f,element_to_argument<nth_t<BS,one>,E>::call(e),
+                            element_to_argument<nth_t<BS,int_constant<2>>,D>::call(d),std::forward<AS>(as)...);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls the method once per pair of elements from two segments. As before, the cell of the
+*   omm table is known in compile time.
+*    - IsDispatched : A bool_constant indicating whether the types of both segments participate in the method.
+*    - T : The omm table.
+*    - D : The type of the elements in the first segment.
+*    - E : The type of the elements in the second segment.
+*/
+template<typename IsDispatched, typename T, typename D, typename E>
+struct segment_pair_dispatch{
+    template<typename... AS>
+    static void call(std::vector<D>&, std::vector<E>&, AS&&...){}
+};
+
+template<typename T, typename D, typename E>
+struct segment_pair_dispatch<std::true_type,T,D,E>{
+
+    template<std::size_t... IS, typename... AS>
+    static void call_each(std::vector<D>& first, std::vector<E>& second, std::index_sequence<IS...>, AS&&... as){
+        constexpr int s0 = position_v<D,car_t<typename T::TID>>;
+        constexpr int s1 = position_v<E,nth_t<typename T::TID,one>>;
+        auto f = T::cell(T::cell_of_slots(s0,s1));
+        for (D& d : first)
+            for (E& e : second)
+                segment_pair_cell_call<(is_symmetric_omm_v<T> && s0 > s1)>::template call<typename T::BS>(f,d,e,
+                    repeated_argument<std::is_reference_t<nth_t<typename T::BS,int_constant<IS+3>>>>::template get<AS>(as)...);
+    }
+
+    template<typename... AS>
+    static void call(std::vector<D>& first, std::vector<E>& second, AS&&... as){
+        call_each(first,second,std::index_sequence_for<AS...>{},std::forward<AS>(as)...);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns a tuple with a vector (a segment) per type. The abstract types have no objects, so they
+*   have no segment.
+*    - C : A collection with the types of the segments.
+*/
+template<typename D>
+struct is_storable : std::bool_constant<!std::is_abstract<D>::value>{};
+
+template<typename C>
+struct segments_tuple{};
+
+template<typename... DS>
+struct segments_tuple<collection<DS...>>{
+    using type = std::tuple<std::vector<DS>...>;
+};
+
+template<typename DCL>
+using segments_tuple_t = typename segments_tuple<tlist_to_collection_t<remove_if_not_t<is_storable,DCL>>>::type;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Stores the objects of each derived type in its own contiguous segment. The methods are called
+*   per segment, so the cell of the omm table is resolved once per segment instead of once per object.
+*   The virtual parameters of the methods must be the first parameters of their signature, and the methods
+*   called with dispatch (dispatch_pairs) must have exactly one (two) virtual parameters, since the rest
+*   of arguments are not identified. The rest of arguments are passed to every call (see repeated_argument).
+*   Each segment is a std::vector instead of a block of an arena: a segment must stay contiguous while it
+*   grows, and an arena would keep every buffer left behind by a growth, while std::vector releases them.
+*   Reserving the segments (see reserve) avoids the growths.
+*    - DCL : The derived types whose objects can be stored (see WithDerivedTypes). The abstract ones are skipped.
+*/
+template<typename DCL>
+class segmented_collection{
+
+    segments_tuple_t<DCL> segments;
+
+public:
+
+    template<typename D, typename... AS>
+    D& emplace(AS&&... as){
+        return segment<D>().emplace_back(std::forward<AS>(as)...);
+    }
+
+    template<typename D>
+    void reserve(std::size_t n){
+        segment<D>().reserve(n);
+    }
+
+    template<typename D>
+    std::vector<D>& segment(){
+        static_assert(!std::is_abstract<D>::value,"An abstract type has no segment");
+        return std::get<std::vector<D>>(segments);
+    }
+
+    template<typename D>
+    const std::vector<D>& segment() const{
+        static_assert(!std::is_abstract<D>::value,"An abstract type has no segment");
+        return std::get<std::vector<D>>(segments);
+    }
+
+    std::size_t size() const{
+        return std::apply([](const auto&... s){ return (s.size() + ... + std::size_t(0)); },segments);
+    }
+
+    template<typename G>
+    void for_each_segment(G&& g){
+        std::apply([&](auto&... s){ (g(s),...); },segments);
+    }
+
+    template<typename T, typename... AS>
+    void dispatch(AS&&... as){
+        static_assert(is_virtual_type_v<nth_t<typename T::VBS,one>>,"The first parameter of the method must be virtual");
+        static_assert(length_v<typename T::TID> == 1,"The method must have exactly one virtual parameter");
+        for_each_segment([&](auto& s){
+            using D = typename std::remove_reference_t<decltype(s)>::value_type;
+            segment_dispatch<std::bool_constant<(position_v<D,car_t<typename T::TID>> >= 0)>,T,D>::call(s,std::forward<AS>(as)...);
+        });
+    }
+
+    template<typename T, typename DCL2, typename... AS>
+    void dispatch_pairs(segmented_collection<DCL2>& other, AS&&... as){
+        static_assert(is_virtual_type_v<nth_t<typename T::VBS,one>> && is_virtual_type_v<nth_t<typename T::VBS,int_constant<2>>>,
+                      "The first two parameters of the method must be virtual");
+        static_assert(length_v<typename T::TID> == 2,"The method must have exactly two virtual parameters");
+        for_each_segment([&](auto& s){
+            using D = typename std::remove_reference_t<decltype(s)>::value_type;
+            other.for_each_segment([&](auto& t){
+                using E = typename std::remove_reference_t<decltype(t)>::value_type;
+                segment_pair_dispatch<std::bool_constant<(position_v<D,car_t<typename T::TID>> >= 0 &&
+                                                          position_v<E,car_t<cdr_t<typename T::TID>>> >= 0)>,T,D,E>::call(s,t,std::forward<AS>(as)...);
+            });
+        });
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//----------------------------------- All pairs -----------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   Returns the address of the object an element of a range refers to. Pointers and smart pointers
+*   are dereferenced, and the rest of elements are the object.
+*    - E : The type of the element.
+*    - e : The element.
+*/
+template<typename E, typename = void>
+struct element_address{
+    static auto call(E& e){
+        return std::addressof(e);
+    }
+};
+
+template<typename E>
+struct element_address<E,std::void_t<decltype(*std::declval<E&>())>>{
+    static auto call(E& e){
+        return std::addressof(*e);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls the function of a cell with a pair of objects, and gives the result to g with the objects.
+*   For symmetric methods, the objects are swapped when the slot of the first one is greater (see
+*   symmetric_dispatch). Methods returning void only give the objects to g.
+*    - BS : The BS type of the method.
+*    - IsVoid : A bool_constant indicating whether the method returns void.
+*    - Swap : Whether the objects are swapped.
+*/
+template<typename BS, typename IsVoid, bool Swap>
+struct pair_cell_call{
+    template<typename Function, typename G, typename A, typename B, typename... AS>
+    static void call(Function f, G& g, A&& a, B&& b, AS&... as){
+        g(a,b,cell_call<BS>::call(f,a,b,as...));
+    }
+};
+
+template<typename BS, typename IsVoid>
+struct pair_cell_call<BS,IsVoid,true>{
+    template<typename Function, typename G, typename A, typename B, typename... AS>
+    static void call(Function f, G& g, A&& a, B&& b, AS&... as){
+        g(a,b,cell_call<BS>::call(f,b,a,as...));
+    }
+};
+
+template<typename BS>
+struct pair_cell_call<BS,std::true_type,false>{
+    template<typename Function, typename G, typename A, typename B, typename... AS>
+    static void call(Function f, G& g, A&& a, B&& b, AS&... as){
+        cell_call<BS>::call(f,a,b,as...);
+        g(a,b);
+    }
+};
+
+template<typename BS>
+struct pair_cell_call<BS,std::true_type,true>{
+    template<typename Function, typename G, typename A, typename B, typename... AS>
+    static void call(Function f, G& g, A&& a, B&& b, AS&... as){
+        cell_call<BS>::call(f,b,a,as...);
+        g(a,b);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The filter of all_pairs that accepts every pair.
+*/
+struct every_pair{
+    template<typename A, typename B>
+    constexpr bool operator()(const A&, const B&) const noexcept{
+        return true;
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Calls a binary method for every pair of objects from two ranges. The slot of every object is
+*   identified once, when the ranges are given, and the objects of each range are grouped by slot. Then,
+*   the pairs are visited by blocks of objects with the same slots, so the function of the cell is read
+*   once per block and no object is identified again. Each block is walked in tiles of Tile x Tile
+*   objects, so the objects of a tile stay in the cache while they are paired.
+*   The pairs are not visited in the order of the ranges. The two virtual parameters must be the first
+*   ones, and they must be pointers or lvalue references.
+*    - T : The omm table.
+*    - Tile : The number of objects of each range in a tile.
+*/
+template<typename T, int Tile = 128>
+class all_pairs{
+
+    using first_parameter  = nth_t<typename T::BS,one>;
+    using second_parameter = nth_t<typename T::BS,int_constant<2>>;
+
+    static_assert(is_virtual_type_v<nth_t<typename T::VBS,one>> && is_virtual_type_v<nth_t<typename T::VBS,int_constant<2>>>,
+                  "The first two parameters of the method must be virtual");
+    static_assert((std::is_pointer<first_parameter>::value || std::is_lvalue_reference<first_parameter>::value) &&
+                  (std::is_pointer<second_parameter>::value || std::is_lvalue_reference<second_parameter>::value),
+                  "The virtual parameters must be pointers or lvalue references");
+
+    template<typename A>
+    using object_type = std::remove_pointer_t<std::remove_reference_t<A>>;
+
+    /**
+    *   The objects of a range sorted by slot. The objects with the slot s are between start[s] and start[s+1].
+    *    - A : The type of the parameter in the BS type.
+    *    - N : The number of the virtual argument.
+    */
+    template<typename A, int N>
+    struct side{
+
+        std::vector<object_type<A>*> objects;
+        std::vector<int> start;
+
+        static A argument(object_type<A>* o){
+            return element_to_argument<A,object_type<A>>::call(*o);
+        }
+
+        template<typename Range>
+        void classify(Range& range){
+            std::vector<std::pair<int,object_type<A>*>> slots;
+            for (auto& e : range){
+                object_type<A>* o = element_address<std::remove_reference_t<decltype(e)>>::call(e);
+                slots.emplace_back(T::template slot<N>(argument(o)),o);
+            }
+            start.assign(T::template slots<N>+1,0);
+            for (auto& s : slots)
+                ++start[s.first+1];
+            for (int k = 0; k < T::template slots<N>; ++k)
+                start[k+1] += start[k];
+            std::vector<int> next(start.begin(),start.end()-1);
+            objects.resize(slots.size());
+            for (auto& s : slots)
+                objects[next[s.first]++] = s.second;
+        }
+    };
+
+    side<first_parameter,0> first;
+    side<second_parameter,1> second;
+
+    template<bool Swap, typename Function, typename Filter, typename G, typename... AS>
+    void block(Function f, Filter& filter, G& g, int s0, int s1, AS&... as) const{
+        using is_void = typename std::is_void<car_t<typename T::BS>>::type;
+        for (int i0 = first.start[s0]; i0 < first.start[s0+1]; i0 += Tile){
+            int i1 = std::min(i0+Tile,first.start[s0+1]);
+            for (int j0 = second.start[s1]; j0 < second.start[s1+1]; j0 += Tile){
+                int j1 = std::min(j0+Tile,second.start[s1+1]);
+                for (int i = i0; i < i1; ++i){
+                    first_parameter a = first.argument(first.objects[i]);
+                    for (int j = j0; j < j1; ++j){
+                        second_parameter b = second.argument(second.objects[j]);
+                        if (filter(a,b))
+                            pair_cell_call<typename T::BS,is_void,Swap>::call(f,g,a,b,as...);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+
+    template<typename FirstRange, typename SecondRange>
+    all_pairs(FirstRange& first_range, SecondRange& second_range){
+        first.classify(first_range);
+        second.classify(second_range);
+    }
+
+    std::size_t pairs() const{
+        return first.objects.size()*second.objects.size();
+    }
+
+    /**
+    *   Calls the method for every pair accepted by the filter, and gives the result to g as g(a,b,result),
+    *   or g(a,b) if the method returns void. The rest of arguments of the method are as....
+    */
+    template<typename Filter, typename G, typename... AS>
+    void dispatch_filtered(Filter&& filter, G&& g, AS&&... as) const{
+        for (int s0 = 0; s0 < T::template slots<0>; ++s0){
+            if (first.start[s0] == first.start[s0+1])
+                continue;
+            for (int s1 = 0; s1 < T::template slots<1>; ++s1){
+                if (second.start[s1] == second.start[s1+1])
+                    continue;
+                auto f = T::cell(T::cell_of_slots(s0,s1));
+                if (is_symmetric_omm_v<T> && s0 > s1)
+                    block<true>(f,filter,g,s0,s1,as...);
+                else
+                    block<false>(f,filter,g,s0,s1,as...);
+            }
+        }
+    }
+
+    template<typename G, typename... AS>
+    void dispatch(G&& g, AS&&... as) const{
+        every_pair filter;
+        dispatch_filtered(filter,g,as...);
+    }
+};
+
+
+//---------------------------------------------------------------------------------
+//------------------------------ Parallel reduction -------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   A fixed set of threads that run the tasks of parallel_reduce. The thread calling run works too, so
+*   a pool of n threads starts n-1 workers, which wait while there is nothing to run. run must not be
+*   called from two threads at the same time.
+*/
+class thread_pool{
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    unsigned long generation = 0;
+    std::size_t busy = 0;
+    bool stop = false;
+
+    // The current run. It is written before generation changes, so the workers read it after the lock.
+    void (*job)(void*,int) = nullptr;
+    void* context = nullptr;
+    int tasks = 0;
+    std::atomic<int> next{0};
+    std::exception_ptr error;
+
+    void work(){
+        for (int k = next.fetch_add(1,std::memory_order_relaxed); k < tasks; k = next.fetch_add(1,std::memory_order_relaxed)){
+            try{
+                job(context,k);
+            }
+            catch (...){
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    }
+
+    void loop(){
+        unsigned long seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+            start.wait(lock,[&]{ return stop || generation != seen; });
+            if (stop)
+                return;
+            seen = generation;
+            lock.unlock();
+            work();
+            lock.lock();
+            if (--busy == 0)
+                done.notify_one();
+        }
+    }
+
+public:
+
+    /**
+    *   - threads : The number of threads, including the one calling run. By default, the number of
+    *     hardware threads.
+    */
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency()){
+        for (unsigned k = 1; k < threads; ++k)
+            workers.emplace_back([this]{ loop(); });
+    }
+
+    ~thread_pool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        start.notify_all();
+        for (std::thread& w : workers)
+            w.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    unsigned size() const{
+        return workers.size()+1;
+    }
+
+    /**
+    *   Calls f(k) for every k in [0,count) from all the threads, and returns when every call has
+    *   returned. If some call throws, the first exception is thrown again here.
+    */
+    template<typename Function>
+    void run(int count, Function&& f){
+        using function_type = std::remove_reference_t<Function>;
+        if (count <= 1 || workers.empty()){
+            for (int k = 0; k < count; ++k)
+                f(k);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [](void* c, int k){ (*static_cast<function_type*>(c))(k); };
+            context = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+            tasks = count;
+            next.store(0,std::memory_order_relaxed);
+            busy = workers.size();
+            ++generation;
+        }
+        start.notify_all();
+        work();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock,[&]{ return busy == 0; });
+        if (error)
+            std::rethrow_exception(std::exchange(error,nullptr));
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The shape of the tree of parallel_reduce.
+*    - per_thread : Each thread folds a contiguous part of the range from left to right, and then the
+*      results of the parts are folded in order. The tree depends on the number of threads.
+*    - fixed : The adjacent pairs are combined level by level, like a balanced binary tree. The tree
+*      only depends on the length of the range, so any pool gives the same result.
+*/
+enum class reduction_tree{ per_thread, fixed };
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Reduces a range with a binary method. The result of the method is combined again, so it must be
+*   (or point to) an object that can be passed as both virtual arguments. The objects are identified
+*   before they are combined, and the method is called through the function of its cell. The two
+*   virtual parameters must be the first ones, and they must be pointers or lvalue references.
+*    - T : The omm table.
+*/
+template<typename T>
+struct reduction{
+
+    using first_parameter  = nth_t<typename T::BS,one>;
+    using second_parameter = nth_t<typename T::BS,int_constant<2>>;
+    using result_type      = car_t<typename T::BS>;
+    using object           = std::remove_pointer_t<std::remove_reference_t<first_parameter>>;
+
+    static_assert(is_virtual_type_v<nth_t<typename T::VBS,one>> && is_virtual_type_v<nth_t<typename T::VBS,int_constant<2>>>,
+                  "The first two parameters of the method must be virtual");
+    static_assert((std::is_pointer<first_parameter>::value || std::is_lvalue_reference<first_parameter>::value) &&
+                  (std::is_pointer<second_parameter>::value || std::is_lvalue_reference<second_parameter>::value),
+                  "The virtual parameters must be pointers or lvalue references");
+    static_assert(std::is_same<object,std::remove_pointer_t<std::remove_reference_t<second_parameter>>>::value,
+                  "The virtual parameters must have the same type");
+    static_assert(!std::is_void<result_type>::value, "The method must return the combined object");
+
+    // The objects identified at once, and the pairs combined by each task of a level of the fixed tree.
+    static constexpr int grain = 256;
+
+    static object* address(result_type& r){
+        return element_address<result_type>::call(r);
+    }
+
+    static int first_slot(object* o){
+        return T::template slot<0>(element_to_argument<first_parameter,object>::call(*o));
+    }
+
+    static int second_slot(object* o){
+        return T::template slot<1>(element_to_argument<second_parameter,object>::call(*o));
+    }
+
+    template<typename... AS>
+    static result_type combine(int s0, int s1, object* a, object* b, AS&... as){
+        auto f = T::cell(T::cell_of_slots(s0,s1));
+        if (is_symmetric_omm_v<T> && s0 > s1)
+            return cell_call<typename T::BS>::call(f,element_to_argument<first_parameter,object>::call(*b),
+                                                   element_to_argument<second_parameter,object>::call(*a),as...);
+        return cell_call<typename T::BS>::call(f,element_to_argument<first_parameter,object>::call(*a),
+                                               element_to_argument<second_parameter,object>::call(*b),as...);
+    }
+
+    /**
+    *   The addresses of init and the elements of the range.
+    */
+    template<typename Range>
+    static std::vector<object*> objects(Range& range, std::optional<result_type>& init){
+        std::vector<object*> result;
+        result.push_back(address(*init));
+        for (auto& e : range)
+            result.push_back(element_address<std::remove_reference_t<decltype(e)>>::call(e));
+        return result;
+    }
+
+    /**
+    *   Folds count objects (two at least) from left to right. The objects are identified by blocks, which
+    *   are combined while they are still in the cache.
+    */
+    template<typename... AS>
+    static std::optional<result_type> fold(object* const* objects, int count, AS&... as){
+        std::optional<result_type> value(combine(first_slot(objects[0]),second_slot(objects[1]),objects[0],objects[1],as...));
+        std::array<int,grain> slots;
+        for (int b0 = 2; b0 < count; b0 += grain){
+            int b1 = std::min(b0+grain,count);
+            for (int i = b0; i < b1; ++i)
+                slots[i-b0] = second_slot(objects[i]);
+            for (int i = b0; i < b1; ++i)
+                value = combine(first_slot(address(*value)),slots[i-b0],address(*value),objects[i],as...);
+        }
+        return value;
+    }
+
+    template<typename Range, typename... AS>
+    static result_type per_thread(thread_pool& pool, Range& range, std::optional<result_type>& init, AS&... as){
+        std::vector<object*> level = objects(range,init);
+        int n = level.size();
+        int parts = std::min<int>(pool.size(),n/2);
+        if (parts == 0)
+            return std::move(*init);
+        // Every part has two objects at least.
+        std::vector<std::optional<result_type>> values(parts);
+        pool.run(parts,[&](int k){
+            int i0 = static_cast<long>(n)*k/parts, i1 = static_cast<long>(n)*(k+1)/parts;
+            values[k] = fold(level.data()+i0,i1-i0,as...);
+        });
+        for (int k = 1; k < parts; ++k)
+            values[0] = combine(first_slot(address(*values[0])),second_slot(address(*values[k])),
+                                address(*values[0]),address(*values[k]),as...);
+        return std::move(*values[0]);
+    }
+
+    /**
+    *   The leaves of the fixed tree are blocks of grain objects folded from left to right, so the results
+    *   alive at the same time are few. Then, the adjacent pairs of each level are combined.
+    */
+    template<typename Range, typename... AS>
+    static result_type fixed(thread_pool& pool, Range& range, std::optional<result_type>& init, AS&... as){
+        std::vector<object*> leaves = objects(range,init);
+        int n = leaves.size();
+        if (n == 1)
+            return std::move(*init);
+        // The owner of each object of the level, if it is the result of a previous level. Each result is
+        // destroyed by the task that combines it.
+        std::vector<std::vector<std::optional<result_type>>> results;
+        results.emplace_back((n+grain-1)/grain);
+        std::vector<object*> level(results.back().size());
+        std::vector<std::optional<result_type>*> owners(level.size(),nullptr);
+        pool.run(level.size(),[&](int k){
+            std::vector<std::optional<result_type>>& values = results.front();
+            int i0 = k*grain, i1 = std::min(i0+grain,n);
+            if (i1-i0 == 1){
+                level[k] = leaves[i0];
+                return;
+            }
+            values[k] = fold(leaves.data()+i0,i1-i0,as...);
+            level[k] = address(*values[k]);
+            owners[k] = &values[k];
+        });
+        std::vector<int> slots;
+        while (level.size() > 1){
+            int pairs = level.size()/2;
+            results.emplace_back(pairs);
+            std::vector<std::optional<result_type>>& values = results.back();
+            std::vector<object*> next_level((level.size()+1)/2);
+            std::vector<std::optional<result_type>*> next_owners(next_level.size());
+            slots.resize(2*pairs);
+            pool.run((pairs+grain-1)/grain,[&](int k){
+                int p0 = k*grain, p1 = std::min(p0+grain,pairs);
+                for (int p = p0; p < p1; ++p){
+                    slots[2*p] = first_slot(level[2*p]);
+                    slots[2*p+1] = second_slot(level[2*p+1]);
+                }
+                for (int p = p0; p < p1; ++p){
+                    values[p] = combine(slots[2*p],slots[2*p+1],level[2*p],level[2*p+1],as...);
+                    for (int i = 2*p; i < 2*p+2; ++i)
+                        if (owners[i])
+                            owners[i]->reset();
+                    next_level[p] = address(*values[p]);
+                    next_owners[p] = &values[p];
+                }
+            });
+            if (level.size()%2){
+                next_level.back() = level.back();
+                next_owners.back() = owners.back();
+            }
+            level.swap(next_level);
+            owners.swap(next_owners);
+        }
+        return std::move(**owners[0]);
+    }
+};
+
+template<reduction_tree Tree>
+struct reduction_tree_call{
+    template<typename T, typename... AS>
+    static car_t<typename T::BS> call(AS&&... as){
+        return reduction<T>::per_thread(as...);
+    }
+};
+
+template<>
+struct reduction_tree_call<reduction_tree::fixed>{
+    template<typename T, typename... AS>
+    static car_t<typename T::BS> call(AS&&... as){
+        return reduction<T>::fixed(as...);
+    }
+};
+
+/**
+*   Combines init and the elements of a range, in this order, with a binary method: the result is
+*   combine(...combine(combine(init,e1),e2)...,en) if the method is associative. The objects are combined
+*   in a tree of tasks run by the threads of the pool.
+*    - T : The omm table.
+*    - Tree : The shape of the tree (see reduction_tree).
+*    - pool : The threads.
+*    - range : The elements. They can be pointers, smart pointers or objects.
+*    - init : The first object.
+*    - as : The rest of arguments of every call to the method.
+*/
+template<typename T, reduction_tree Tree = reduction_tree::per_thread, typename Range, typename... AS>
+car_t<typename T::BS> parallel_reduce(thread_pool& pool, Range& range, car_t<typename T::BS> init, AS&&... as){
+    std::optional<car_t<typename T::BS>> first(std::move(init));
+    return reduction_tree_call<Tree>::template call<T>(pool,range,first,as...);
+}
+
+
+
+//---------------------------------------------------------------------------------
+//--------------------------------- Dispatch queue --------------------------------
+//---------------------------------------------------------------------------------
+
+/**
+*   The type used to keep an argument of a queued call until it runs. Lvalue references are kept as
+*   references, so the objects must live until the call has run, and the rest of arguments are kept by
+*   value.
+*    - B : The type of the parameter in the BS type.
+*/
+template<typename B>
+using stored_argument_t = std::conditional_t<std::is_lvalue_reference<B>::value,B,std::remove_cv_t<std::remove_reference_t<B>>>;
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Sets the value of a promise to the result of a call, or its exception if it throws.
+*    - R : The return type of the call.
+*/
+template<typename R>
+struct promise_completion{
+    template<typename Call>
+    static void call(std::promise<R>& promise, Call&& c){
+        try{
+            promise.set_value(c());
+        }
+        catch (...){
+            promise.set_exception(std::current_exception());
+        }
+    }
+};
+
+template<>
+struct promise_completion<void>{
+    template<typename Call>
+    static void call(std::promise<void>& promise, Call&& c){
+        try{
+            c();
+            promise.set_value();
+        }
+        catch (...){
+            promise.set_exception(std::current_exception());
+        }
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   The result of a call, or its exception, kept until it is returned by get.
+*    - R : The return type of the call.
+*/
+template<typename R>
+struct queued_result{
+
+    std::optional<R> value;
+    std::exception_ptr error;
+
+    template<typename Call>
+    void set(Call&& c){
+        try{
+            value.emplace(c());
+        }
+        catch (...){
+            error = std::current_exception();
+        }
+    }
+
+    R get(){
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template<>
+struct queued_result<void>{
+
+    std::exception_ptr error;
+
+    template<typename Call>
+    void set(Call&& c){
+        try{
+            c();
+        }
+        catch (...){
+            error = std::current_exception();
+        }
+    }
+
+    void get(){
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+//---------------------------------------------------------------------------------
+
+/**
+*   Runs the calls to a method asynchronously. Producers on any thread submit calls without locks: the
+*   cell of each call is found in the producer, and the call is pushed to the queue of the producer,
+*   so the producers of different queues do not contend. There is a queue per hardware thread by default.
+*   Each consumer thread takes all the calls of its queues at once, groups them by cell and calls the
+*   function of each cell for its whole batch. The calls are not run in the order they were submitted,
+*   but the calls of a producer to the same cell are. When the dispatch_queue is destroyed, the consumers
+*   run the remaining calls and finish. The method is given as an omm table whose cells receive the
+*   arguments in order (not a symmetric table).
+*    - T : The omm table.
+*/
+template<typename T>
+class dispatch_queue{
+
+    static_assert(!is_symmetric_omm_v<T>, "The calls of symmetric tables can not be queued");
+
+    using function       = decltype(T::cell(0));
+    using arguments_type = tlist_to_collection_t<cdr_t<typename T::BS>>;
+
+public:
+
+    using result_type = car_t<typename T::BS>;
+
+private:
+
+    struct queued_call{
+        queued_call* next;
+        int cell;
+        // Calls the function of the cell and completes the call. The call may be destroyed.
+        void (*run)(queued_call*, function);
+    };
+
+    template<typename Arguments>
+    struct stored_call;
+
+    template<typename... Bargs>
+    struct stored_call<collection<Bargs...>> : queued_call{
+
+        std::tuple<stored_argument_t<Bargs>...> arguments;
+
+        template<typename... AS>
+        stored_call(int cell, AS&&... as) : queued_call{nullptr,cell,nullptr}, arguments(std::forward<AS>(as)...){}
+
+        template<std::size_t... I>
+        result_type invoke(function f, std::index_sequence<I...>){
+            return f(std::forward<Bargs>(std::get<I>(arguments))...);
+        }
+
+        result_type invoke(function f){
+            return invoke(f,std::index_sequence_for<Bargs...>{});
+        }
+    };
+
+    struct future_call : stored_call<arguments_type>{
+
+        std::promise<result_type> promise;
+
+        template<typename... AS>
+        future_call(int cell, AS&&... as) : stored_call<arguments_type>(cell,std::forward<AS>(as)...){
+            this->run = [](queued_call* c, function f){
+                future_call* self = static_cast<future_call*>(c);
+                promise_completion<result_type>::call(self->promise,[&]{ return self->invoke(f); });
+                delete self;
+            };
+        }
+    };
+
+    // The calls of a queue are pushed to the front of a list and the consumer takes the whole list.
+    struct alignas(64) shard{
+        std::atomic<queued_call*> head{nullptr};
+    };
+
+    struct alignas(64) consumer{
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping{false};
+        std::thread thread;
+    };
+
+    int shard_count;
+    int consumer_count;
+    std::unique_ptr<shard[]> shards;
+    std::unique_ptr<consumer[]> consumers;
+    std::atomic<bool> stop{false};
+
+    // Each producer thread gets a queue the first time it submits a call.
+    int producer_shard() const{
+        static std::atomic<unsigned> producers{0};
+        static thread_local unsigned producer = producers.fetch_add(1,std::memory_order_relaxed);
+        return producer%shard_count;
+    }
+
+    void push(queued_call* c){
+        int s = producer_shard();
+        queued_call* head = shards[s].head.load(std::memory_order_relaxed);
+        do{
+            c->next = head;
+        } while (!shards[s].head.compare_exchange_weak(head,c));
+        // With sleeping, either the consumer sees the call before it sleeps or the producer wakes it.
+        consumer& k = consumers[s%consumer_count];
+        if (k.sleeping.load()){
+            { std::lock_guard<std::mutex> lock(k.mutex); }
+            k.wake.notify_one();
+        }
+    }
+
+    bool has_calls(int k) const{
+        for (int s = k; s < shard_count; s += consumer_count)
+            if (shards[s].head.load())
+                return true;
+        return false;
+    }
+
+    // Waits for calls. Returns false if the consumer must finish.
+    bool wait(int k){
+        for (int spin = 0; spin < 64; ++spin){
+            if (has_calls(k))
+                return true;
+            std::this_thread::yield();
+        }
+        consumer& c = consumers[k];
+        std::unique_lock<std::mutex> lock(c.mutex);
+        c.sleeping.store(true);
+        c.wake.wait(lock,[&]{ return stop.load() || has_calls(k); });
+        c.sleeping.store(false);
+        return has_calls(k);
+    }
+
+    void consume(int k){
+        std::vector<queued_call*> batch;
+        while (true){
+            batch.clear();
+            for (int s = k; s < shard_count; s += consumer_count){
+                std::size_t first = batch.size();
+                for (queued_call* c = shards[s].head.exchange(nullptr,std::memory_order_acquire); c; c = c->next)
+                    batch.push_back(c);
+                std::reverse(batch.begin()+first,batch.end());
+            }
+            if (batch.empty()){
+                if (!wait(k))
+                    return;
+                continue;
+            }
+            std::stable_sort(batch.begin(),batch.end(),[](const queued_call* a, const queued_call* b){ return a->cell < b->cell; });
+            for (std::size_t i = 0; i < batch.size();){
+                int cell = batch[i]->cell;
+                function f = T::cell(cell);
+                for (; i < batch.size() && batch[i]->cell == cell; ++i)
+                    batch[i]->run(batch[i],f);
+            }
+        }
+    }
+
+public:
+
+    /**
+    *   - consumers : The number of consumer threads.
+    *   - queues : The number of queues. By default, the number of hardware threads.
+    */
+    explicit dispatch_queue(int consumers = 1, int queues = std::thread::hardware_concurrency())
+        : shard_count(std::max({queues,consumers,1})), consumer_count(std::max(consumers,1)),
+          shards(new shard[shard_count]), consumers(new consumer[consumer_count]){
+        for (int k = 0; k < consumer_count; ++k)
+            this->consumers[k].thread = std::thread([this,k]{ consume(k); });
+    }
+
+    ~dispatch_queue(){
+        stop.store(true);
+        for (int k = 0; k < consumer_count; ++k){
+            { std::lock_guard<std::mutex> lock(consumers[k].mutex); }
+            consumers[k].wake.notify_one();
+        }
+        for (int k = 0; k < consumer_count; ++k)
+            consumers[k].thread.join();
+    }
+
+    dispatch_queue(const dispatch_queue&) = delete;
+    dispatch_queue& operator=(const dispatch_queue&) = delete;
+
+    /**
+    *   Queues a call with the arguments as. The future gets the result of the call, or its exception.
+    */
+    template<typename... AS>
+    std::future<result_type> submit(AS&&... as){
+        future_call* c = new future_call(T::cell_of(as...),std::forward<AS>(as)...);
+        std::future<result_type> result = c->promise.get_future();
+        push(c);
+        return result;
+    }
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+    /**
+    *   The result of async. When it is awaited, the call is queued and the coroutine is resumed by the
+    *   consumer thread after the call, so the call does not need any allocation.
+    */
+    class awaitable : stored_call<arguments_type>{
+
+        friend class dispatch_queue;
+
+        dispatch_queue* queue;
+        queued_result<result_type> result;
+        std::coroutine_handle<> handle;
+
+        template<typename... AS>
+        awaitable(dispatch_queue* queue, int cell, AS&&... as) : stored_call<arguments_type>(cell,std::forward<AS>(as)...), queue(queue){
+            this->run = [](queued_call* c, function f){
+                awaitable* self = static_cast<awaitable*>(c);
+                self->result.set([&]{ return self->invoke(f); });
+                self->handle.resume();
+            };
+        }
+
+    public:
+
+        awaitable(const awaitable&) = delete;
+        awaitable& operator=(const awaitable&) = delete;
+
+        bool await_ready() const noexcept{
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> h){
+            handle = h;
+            queue->push(this);
+        }
+
+        result_type await_resume(){
+            return result.get();
+        }
+    };
+
+    /**
+    *   Queues a call with the arguments as when the result is awaited: co_await queue.async(as...).
+    */
+    template<typename... AS>
+    awaitable async(AS&&... as){
+        return awaitable(this,T::cell_of(as...),std::forward<AS>(as)...);
+    }
+
+#endif
+};
+
+
+
+#endif // OMM_EXTRAS_H_INCLUDED